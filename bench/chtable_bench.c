@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include "misc/htable.h"
+#include "misc/chtable.h"
+
+#define N_KEYS        1000000
+#define N_PER_THREAD  2000000
+#define MAX_THREADS   16
+
+typedef struct Reader
+{
+    misc_chtable ch;
+    misc_htable ht;
+    pthread_mutex_t *mutex;
+    unsigned int seed;
+    long hits;
+} Reader;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void* read_sharded(void *arg)
+{
+    Reader *r = (Reader*)arg;
+    int value;
+
+    for (int i = 0; i < N_PER_THREAD; i++)
+    {
+        int key = rand_r(&r->seed) % N_KEYS;
+        r->hits += misc_chtable_get(r->ch, &key, &value);
+    }
+
+    return NULL;
+}
+
+static void* read_global_mutex(void *arg)
+{
+    Reader *r = (Reader*)arg;
+
+    for (int i = 0; i < N_PER_THREAD; i++)
+    {
+        int key = rand_r(&r->seed) % N_KEYS;
+        pthread_mutex_lock(r->mutex);
+        r->hits += misc_htable_get(r->ht, &key) != NULL;
+        pthread_mutex_unlock(r->mutex);
+    }
+
+    return NULL;
+}
+
+static double run(void *(*fn)(void*), Reader *proto, int nthreads)
+{
+    pthread_t threads[MAX_THREADS];
+    Reader readers[MAX_THREADS];
+
+    double start = now_sec();
+    for (int i = 0; i < nthreads; i++)
+    {
+        readers[i] = *proto;
+        readers[i].seed = (unsigned int)i + 1;
+        pthread_create(&threads[i], NULL, fn, &readers[i]);
+    }
+    for (int i = 0; i < nthreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    double elapsed = now_sec() - start;
+
+    return (double)nthreads * N_PER_THREAD / elapsed / 1e6;
+}
+
+int main()
+{
+    // +-------------------------------------------------------+
+    // | read throughput of a sharded misc_chtable against a   |
+    // | misc_htable behind one global mutex, as threads grow  |
+    // +-------------------------------------------------------+
+
+    misc_chtable ch = misc_chtable_create_int(sizeof(int), 64, MISC_HTABLE_DEFAULT);
+    misc_htable ht = misc_htable_create_int(sizeof(int), MISC_HTABLE_DEFAULT);
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+    for (int i = 0; i < N_KEYS; i++)
+    {
+        misc_chtable_put(ch, &i, &i);
+        misc_htable_put(ht, &i, &i);
+    }
+
+    Reader proto = {ch, ht, &mutex, 0, 0};
+
+    printf("%d keys, %d lookups per thread\n\n", N_KEYS, N_PER_THREAD);
+    printf("threads   chtable (Mops/s)   htable+mutex (Mops/s)\n");
+    for (int nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 2)
+    {
+        double sharded = run(read_sharded, &proto, nthreads);
+        double global = run(read_global_mutex, &proto, nthreads);
+        printf("%7d   %16.2f   %21.2f\n", nthreads, sharded, global);
+    }
+
+    misc_chtable_destroy(ch);
+    misc_htable_destroy(ht);
+    return 0;
+}
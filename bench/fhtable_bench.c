@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "misc/htable.h"
+#include "misc/fhtable.h"
+
+#define N_KEYS    1000000
+#define N_LOOKUPS 4000000
+#define BENCH_PATH "fhtable_bench.fht"
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main()
+{
+    // +-------------------------------------------------------------+
+    // | startup cost of a large string table: building it with puts |
+    // | against mapping a frozen copy, and lookups on both          |
+    // +-------------------------------------------------------------+
+
+    srand(42);
+
+    char **keys = (char**)malloc(N_KEYS * sizeof(char*));
+    int *order = (int*)malloc(N_LOOKUPS * sizeof(int));
+    for (int i = 0; i < N_KEYS; i++)
+    {
+        keys[i] = (char*)malloc(48);
+        snprintf(keys[i], 48, "user:%d:session:%d", i, rand());
+    }
+    for (int i = 0; i < N_LOOKUPS; i++) order[i] = rand() % N_KEYS;
+
+    double start = now_sec();
+    misc_htable ht = misc_htable_create_str_owned(sizeof(long), MISC_HTABLE_DEFAULT);
+    for (long i = 0; i < N_KEYS; i++)
+    {
+        misc_htable_put(ht, &keys[i], &i);
+    }
+    double build = now_sec() - start;
+
+    start = now_sec();
+    misc_htable_freeze(ht, BENCH_PATH);
+    double freeze = now_sec() - start;
+
+    start = now_sec();
+    misc_fhtable ft = misc_fhtable_open(BENCH_PATH, NULL, NULL);
+    double open = now_sec() - start;
+    if (ft == NULL)
+    {
+        printf("could not open %s\n", BENCH_PATH);
+        return 1;
+    }
+
+    long hits = 0;
+    start = now_sec();
+    for (int i = 0; i < N_LOOKUPS; i++)
+    {
+        hits += misc_htable_get(ht, &keys[order[i]]) != NULL;
+    }
+    double ht_lookup = now_sec() - start;
+
+    start = now_sec();
+    for (int i = 0; i < N_LOOKUPS; i++)
+    {
+        hits += misc_fhtable_get(ft, &keys[order[i]]) != NULL;
+    }
+    double ft_lookup = now_sec() - start;
+
+    if (hits != 2L * N_LOOKUPS) printf("  (unexpected: %ld hits)\n", hits);
+
+    printf("%d string keys, %d lookups\n", N_KEYS, N_LOOKUPS);
+    printf("  build with puts  %8.2f ms\n", build * 1e3);
+    printf("  freeze           %8.2f ms\n", freeze * 1e3);
+    printf("  open (mmap)      %8.2f ms\n", open * 1e3);
+    printf("  htable lookups   %8.2f Mlookups/s\n", N_LOOKUPS / ht_lookup / 1e6);
+    printf("  fhtable lookups  %8.2f Mlookups/s (first pass faults pages in)\n", N_LOOKUPS / ft_lookup / 1e6);
+
+    misc_fhtable_close(ft);
+    misc_htable_destroy(ht);
+    remove(BENCH_PATH);
+
+    for (int i = 0; i < N_KEYS; i++) free(keys[i]);
+    free(keys);
+    free(order);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "misc/htable.h"
+#include "misc/vector.h"
+#include "misc/groupby.h"
+
+#define N_EVENTS    4000000
+#define N_USERS     100000
+#define MAX_THREADS 16
+
+typedef struct Event
+{
+    int user;
+    int amount;
+} Event;
+
+typedef struct Total
+{
+    long sum;
+    long count;
+} Total;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static const void* event_user(const void *record)
+{
+    return &((const Event*)record)->user;
+}
+
+static void add_event(void *acc, const void *record, int first, void *ctx)
+{
+    (void)first;
+    (void)ctx;
+
+    Total *total = (Total*)acc;
+    total->sum += ((const Event*)record)->amount;
+    total->count++;
+}
+
+int main()
+{
+    // +--------------------------------------------------------+
+    // | per-user totals over a vector of events: a get/put     |
+    // | loop on one misc_htable against misc_groupby           |
+    // +--------------------------------------------------------+
+
+    srand(42);
+
+    misc_vector events = misc_vector_create(sizeof(Event));
+    for (int i = 0; i < N_EVENTS; i++)
+    {
+        Event e = { rand() % N_USERS, rand() % 100 };
+        misc_vector_pushback(events, &e);
+    }
+
+    double start = now_sec();
+    misc_htable loop = misc_htable_create_int(sizeof(Total), MISC_HTABLE_DEFAULT);
+    for (int i = 0; i < N_EVENTS; i++)
+    {
+        const Event *e = (const Event*)misc_vector_get(events, i);
+        Total total = { 0, 0 };
+        Total *found = (Total*)misc_htable_get(loop, &e->user);
+        if (found != NULL) total = *found;
+
+        total.sum += e->amount;
+        total.count++;
+        misc_htable_put(loop, &e->user, &total);
+    }
+    double loop_time = now_sec() - start;
+
+    printf("%d events, %d users\n\n", N_EVENTS, N_USERS);
+    printf("get/put loop      %8.2f ms\n", loop_time * 1e3);
+
+    for (int nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 2)
+    {
+        misc_htable out = misc_htable_create_int(sizeof(Total), MISC_HTABLE_DEFAULT);
+
+        start = now_sec();
+        misc_groupby(events, out, event_user, add_event, NULL, nthreads);
+        double elapsed = now_sec() - start;
+
+        int user = 0;
+        const Total *a = (const Total*)misc_htable_get(out, &user);
+        const Total *b = (const Total*)misc_htable_get(loop, &user);
+        if (a == NULL || b == NULL || a->sum != b->sum) printf("  (unexpected: totals differ)\n");
+
+        printf("groupby %2d thr    %8.2f ms\n", nthreads, elapsed * 1e3);
+        misc_htable_destroy(out);
+    }
+
+    misc_htable_destroy(loop);
+    misc_vector_destroy(events);
+    return 0;
+}
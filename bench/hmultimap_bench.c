@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "misc/htable.h"
+#include "misc/hmultimap.h"
+#include "misc/vector.h"
+
+#define N_KEYS     100000
+#define N_POSTINGS 2000000
+#define N_QUERIES  2000000
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main()
+{
+    // +-------------------------------------------------------------+
+    // | inverted index on int keys: a misc_vector handle per key as |
+    // | the htable value, against misc_hmultimap's inline runs      |
+    // +-------------------------------------------------------------+
+
+    srand(42);
+
+    int *keys = (int*)malloc(N_POSTINGS * sizeof(int));
+    int *queries = (int*)malloc(N_QUERIES * sizeof(int));
+    for (int i = 0; i < N_POSTINGS; i++) keys[i] = rand() % N_KEYS;
+    for (int i = 0; i < N_QUERIES; i++) queries[i] = rand() % N_KEYS;
+
+    /* misc_vector per key */
+    double start = now_sec();
+    misc_htable ht = misc_htable_create_int(sizeof(misc_vector), MISC_HTABLE_DEFAULT);
+    for (int i = 0; i < N_POSTINGS; i++)
+    {
+        int inserted;
+        misc_vector *vec = (misc_vector*)misc_htable_get_or_insert(ht, &keys[i], &inserted);
+        if (inserted) *vec = misc_vector_create(sizeof(int));
+        misc_vector_pushback(*vec, &i);
+    }
+    double vec_build = now_sec() - start;
+
+    long vec_sum = 0;
+    start = now_sec();
+    for (int q = 0; q < N_QUERIES; q++)
+    {
+        misc_vector *vec = (misc_vector*)misc_htable_get(ht, &queries[q]);
+        if (vec == NULL) continue;
+
+        size_t count = misc_vector_length(*vec);
+        if (count > 0) vec_sum += *(int*)misc_vector_get(*vec, count - 1);
+    }
+    double vec_query = now_sec() - start;
+
+    misc_htable_iter it;
+    void *value;
+    misc_htable_iter_begin(ht, &it);
+    while (misc_htable_iter_next(&it, NULL, &value))
+    {
+        misc_vector_destroy(*(misc_vector*)value);
+    }
+    misc_htable_destroy(ht);
+
+    /* misc_hmultimap */
+    start = now_sec();
+    misc_hmultimap mm = misc_hmultimap_create_int(sizeof(int), MISC_HTABLE_DEFAULT);
+    for (int i = 0; i < N_POSTINGS; i++)
+    {
+        misc_hmultimap_add(mm, &keys[i], &i);
+    }
+    double mm_build = now_sec() - start;
+
+    long mm_sum = 0;
+    start = now_sec();
+    for (int q = 0; q < N_QUERIES; q++)
+    {
+        const void *values;
+        size_t count;
+        if (misc_hmultimap_get_all(mm, &queries[q], &values, &count))
+        {
+            mm_sum += ((const int*)values)[count - 1];
+        }
+    }
+    double mm_query = now_sec() - start;
+
+    misc_hmultimap_destroy(mm);
+
+    if (vec_sum != mm_sum) printf("  (unexpected: checksums differ)\n");
+
+    printf("%d keys, %d postings, %d queries\n", N_KEYS, N_POSTINGS, N_QUERIES);
+    printf("  htable + misc_vector  build %8.2f ms   query %8.2f Mq/s\n",
+           vec_build * 1e3, N_QUERIES / vec_query / 1e6);
+    printf("  misc_hmultimap        build %8.2f ms   query %8.2f Mq/s\n",
+           mm_build * 1e3, N_QUERIES / mm_query / 1e6);
+
+    free(keys);
+    free(queries);
+    return 0;
+}
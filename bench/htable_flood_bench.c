@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "misc/htable.h"
+
+#define N_KEYS     8000
+#define N_LOOKUPS  100000
+#define ATTACK_CAP 16384
+#define ATTACK_RUN 32
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void bench(const char *label, int flags, const int *keys)
+{
+    misc_htable ht = misc_htable_create_int(sizeof(int), flags);
+
+    double start = now_sec();
+    for (int i = 0; i < N_KEYS; i++)
+    {
+        misc_htable_put(ht, &keys[i], &i);
+    }
+    double insert = now_sec() - start;
+
+    start = now_sec();
+    long hits = 0;
+    for (int i = 0; i < N_LOOKUPS; i++)
+    {
+        hits += misc_htable_get(ht, &keys[(size_t)i * 7919 % N_KEYS]) != NULL;
+    }
+    double lookup = now_sec() - start;
+
+    if (hits != N_LOOKUPS) printf("  (unexpected: %ld hits)\n", hits);
+    printf("  %-26s insert %8.2f ms   lookup %8.2f Mops/s\n",
+           label, insert * 1e3, N_LOOKUPS / lookup / 1e6);
+
+    misc_htable_destroy(ht);
+}
+
+int main()
+{
+    // +--------------------------------------------------------------+
+    // | hash flooding: keys chosen offline so that the unseeded hash |
+    // | puts them all in one probe run, against random keys, with    |
+    // | and without MISC_HTABLE_SEEDED                               |
+    // +--------------------------------------------------------------+
+
+    srand(42);
+
+    int *random_keys = (int*)malloc(N_KEYS * sizeof(int));
+    int *attack_keys = (int*)malloc(N_KEYS * sizeof(int));
+
+    for (int i = 0; i < N_KEYS; i++)
+    {
+        random_keys[i] = i * 2654435761u ^ rand();
+    }
+
+    /*
+     * The attacker knows the unseeded hash: keep the keys whose home slot
+     * falls in the first ATTACK_RUN slots of a table of ATTACK_CAP, which
+     * also holds for every smaller capacity the table grows through.
+     */
+    misc_htable probe = misc_htable_create_int(sizeof(int), MISC_HTABLE_DEFAULT);
+    int found = 0;
+    for (int k = 0; found < N_KEYS; k++)
+    {
+        if ((misc_htable_hash(probe, &k) & (ATTACK_CAP - 1)) < ATTACK_RUN)
+        {
+            attack_keys[found++] = k;
+        }
+    }
+    misc_htable_destroy(probe);
+
+    printf("%d int keys, %d lookups\n", N_KEYS, N_LOOKUPS);
+    bench("unseeded, random keys", MISC_HTABLE_DEFAULT, random_keys);
+    bench("unseeded, attack keys", MISC_HTABLE_DEFAULT, attack_keys);
+    bench("seeded, random keys", MISC_HTABLE_SEEDED, random_keys);
+    bench("seeded, attack keys", MISC_HTABLE_SEEDED, attack_keys);
+
+    free(random_keys);
+    free(attack_keys);
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "misc/htable.h"
+
+#define N_KEYS    200000
+#define N_LOOKUPS 4000000
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static size_t identity_hash(const void *key)
+{
+    return (size_t)(*(const int*)key);
+}
+
+static int int_cmp(const void *a, const void *b)
+{
+    return *(const int*)a != *(const int*)b;
+}
+
+static double bench_lookups(misc_htable ht, const void *keys, size_t key_size, const int *order)
+{
+    for (int i = 0; i < N_KEYS; i++)
+    {
+        misc_htable_put(ht, (const char*)keys + (size_t)i * key_size, &i);
+    }
+
+    double start = now_sec();
+    long hits = 0;
+    for (int i = 0; i < N_LOOKUPS; i++)
+    {
+        hits += misc_htable_get(ht, (const char*)keys + (size_t)order[i] * key_size) != NULL;
+    }
+    double elapsed = now_sec() - start;
+
+    if (hits != N_LOOKUPS) printf("  (unexpected: %ld hits)\n", hits);
+    misc_htable_destroy(ht);
+    return N_LOOKUPS / elapsed / 1e6;
+}
+
+int main()
+{
+    // +------------------------------------------------------------+
+    // | lookup throughput with and without the hash finalizer, for |
+    // | the built-in int and string tables and a weak user hash    |
+    // +------------------------------------------------------------+
+
+    srand(42);
+
+    int *int_keys = (int*)malloc(N_KEYS * sizeof(int));
+    int *strided_keys = (int*)malloc(N_KEYS * sizeof(int));
+    char **str_keys = (char**)malloc(N_KEYS * sizeof(char*));
+    char **url_keys = (char**)malloc(N_KEYS * sizeof(char*));
+    int *order = (int*)malloc(N_LOOKUPS * sizeof(int));
+
+    for (int i = 0; i < N_KEYS; i++)
+    {
+        int_keys[i] = rand();
+        strided_keys[i] = i * 1024;
+        str_keys[i] = (char*)malloc(32);
+        snprintf(str_keys[i], 32, "key-%d", int_keys[i]);
+        url_keys[i] = (char*)malloc(128);
+        snprintf(url_keys[i], 128, "https://www.example.com/catalog/items/view?id=%d&ref=search&lang=en", int_keys[i]);
+    }
+    for (int i = 0; i < N_LOOKUPS; i++) order[i] = rand() % N_KEYS;
+
+    misc_htable ht;
+
+    printf("%d keys, %d lookups\n\n", N_KEYS, N_LOOKUPS);
+
+    ht = misc_htable_create_int(sizeof(int), MISC_HTABLE_DEFAULT);
+    printf("int keys:                     %8.2f Mlookups/s\n",
+           bench_lookups(ht, int_keys, sizeof(int), order));
+
+    ht = misc_htable_create_str(sizeof(int), MISC_HTABLE_DEFAULT);
+    printf("str keys:                     %8.2f Mlookups/s\n",
+           bench_lookups(ht, str_keys, sizeof(char*), order));
+
+    ht = misc_htable_create_str(sizeof(int), MISC_HTABLE_DEFAULT);
+    misc_htable_set_finalizer(ht, NULL);
+    printf("str keys, no finalizer:       %8.2f Mlookups/s\n",
+           bench_lookups(ht, str_keys, sizeof(char*), order));
+
+    ht = misc_htable_create_str(sizeof(int), MISC_HTABLE_DEFAULT);
+    printf("url keys (FNV-1a):            %8.2f Mlookups/s\n",
+           bench_lookups(ht, url_keys, sizeof(char*), order));
+
+    ht = misc_htable_create_str_owned(sizeof(int), MISC_HTABLE_DEFAULT);
+    printf("url keys, owned (wyhash):     %8.2f Mlookups/s\n",
+           bench_lookups(ht, url_keys, sizeof(char*), order));
+
+    ht = misc_htable_create(sizeof(int), sizeof(int), identity_hash, int_cmp, MISC_HTABLE_DEFAULT);
+    printf("strided keys, identity hash:  %8.2f Mlookups/s\n",
+           bench_lookups(ht, strided_keys, sizeof(int), order));
+
+    ht = misc_htable_create(sizeof(int), sizeof(int), identity_hash, int_cmp, MISC_HTABLE_DEFAULT);
+    misc_htable_set_finalizer(ht, NULL);
+    printf("  ... no finalizer:           %8.2f Mlookups/s\n",
+           bench_lookups(ht, strided_keys, sizeof(int), order));
+
+    for (int i = 0; i < N_KEYS; i++)
+    {
+        free(str_keys[i]);
+        free(url_keys[i]);
+    }
+    free(int_keys);
+    free(strided_keys);
+    free(str_keys);
+    free(url_keys);
+    free(order);
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "misc/htable.h"
+
+#define N_KEYS    1000000
+#define N_LOOKUPS 4000000
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static double bench_int(int flags, const int *keys, const int *queries, long *found)
+{
+    misc_htable ht = misc_htable_create_int(sizeof(int), flags);
+    for (int i = 0; i < N_KEYS; i++) misc_htable_put(ht, &keys[i], &i);
+
+    double start = now_sec();
+    long hits = 0;
+    for (int i = 0; i < N_LOOKUPS; i++)
+    {
+        hits += misc_htable_contains(ht, &queries[i]);
+    }
+    double elapsed = now_sec() - start;
+
+    *found = hits;
+    misc_htable_destroy(ht);
+    return elapsed;
+}
+
+static double bench_str(int flags, char **keys, char **queries, long *found)
+{
+    misc_htable ht = misc_htable_create_str(sizeof(int), flags);
+    for (int i = 0; i < N_KEYS; i++) misc_htable_put(ht, &keys[i], &i);
+
+    double start = now_sec();
+    long hits = 0;
+    for (int i = 0; i < N_LOOKUPS; i++)
+    {
+        hits += misc_htable_get(ht, &queries[i]) != NULL;
+    }
+    double elapsed = now_sec() - start;
+
+    *found = hits;
+    misc_htable_destroy(ht);
+    return elapsed;
+}
+
+int main()
+{
+    // +---------------------------------------------------------+
+    // | compare scalar probing against SIMD group probing, with |
+    // | half of the lookups hitting and half missing            |
+    // +---------------------------------------------------------+
+
+    srand(42);
+
+    int *keys = (int*)malloc(N_KEYS * sizeof(int));
+    int *queries = (int*)malloc(N_LOOKUPS * sizeof(int));
+    char **str_keys = (char**)malloc(N_KEYS * sizeof(char*));
+    char **str_queries = (char**)malloc(N_LOOKUPS * sizeof(char*));
+    char **misses = (char**)malloc(N_KEYS * sizeof(char*));
+
+    for (int i = 0; i < N_KEYS; i++)
+    {
+        keys[i] = i * 2;
+        str_keys[i] = (char*)malloc(32);
+        misses[i] = (char*)malloc(32);
+        snprintf(str_keys[i], 32, "user:%d:session", i * 2);
+        snprintf(misses[i], 32, "user:%d:session", i * 2 + 1);
+    }
+    for (int i = 0; i < N_LOOKUPS; i++)
+    {
+        int r = rand() % N_KEYS;
+        queries[i] = (i & 1) ? r * 2 : r * 2 + 1;
+        str_queries[i] = (i & 1) ? str_keys[r] : misses[r];
+    }
+
+    long found;
+    double t;
+
+    printf("%d keys, %d lookups (50%% hits)\n\n", N_KEYS, N_LOOKUPS);
+
+    t = bench_int(MISC_HTABLE_DEFAULT, keys, queries, &found);
+    printf("int keys, scalar probe: %8.2f Mlookups/s (%ld hits)\n", N_LOOKUPS / t / 1e6, found);
+    t = bench_int(MISC_HTABLE_GROUP_PROBE, keys, queries, &found);
+    printf("int keys, group probe:  %8.2f Mlookups/s (%ld hits)\n", N_LOOKUPS / t / 1e6, found);
+
+    t = bench_str(MISC_HTABLE_DEFAULT, str_keys, str_queries, &found);
+    printf("str keys, scalar probe: %8.2f Mlookups/s (%ld hits)\n", N_LOOKUPS / t / 1e6, found);
+    t = bench_str(MISC_HTABLE_GROUP_PROBE, str_keys, str_queries, &found);
+    printf("str keys, group probe:  %8.2f Mlookups/s (%ld hits)\n", N_LOOKUPS / t / 1e6, found);
+
+    for (int i = 0; i < N_KEYS; i++)
+    {
+        free(str_keys[i]);
+        free(misses[i]);
+    }
+    free(keys);
+    free(queries);
+    free(str_keys);
+    free(str_queries);
+    free(misses);
+
+    return 0;
+}
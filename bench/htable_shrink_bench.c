@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <malloc.h>
+#include "misc/htable.h"
+
+#define N_PEAK   1000000
+#define N_KEEP   11
+#define N_REFILL 200000
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static size_t heap_bytes(void)
+{
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+/*
+ * A table sized for a burst drains to a handful of entries, shrinks, then
+ * fills up again. With MISC_HTABLE_INCREMENTAL the shrink leaves a large,
+ * sparse old store to migrate while the refill is already growing the new one.
+ */
+static void run(const char *label, int flags)
+{
+    size_t base = heap_bytes();
+    double start = now_sec();
+
+    misc_htable ht = misc_htable_create_int(sizeof(int), flags);
+    misc_htable_reserve(ht, N_PEAK);
+    for (int i = 0; i < N_KEEP; i++) misc_htable_put(ht, &i, &i);
+
+    int drained = 0;
+    misc_htable_remove(ht, &drained);
+    size_t low = heap_bytes() - base;
+
+    for (int i = N_KEEP; i < N_KEEP + N_REFILL; i++) misc_htable_put(ht, &i, &i);
+
+    double elapsed = now_sec() - start;
+
+    long missing = 0;
+    for (int i = 1; i < N_KEEP + N_REFILL; i++)
+    {
+        int *value = (int*)misc_htable_get(ht, &i);
+        if (value == NULL || *value != i) missing++;
+    }
+    if (missing != 0 || misc_htable_size(ht) != N_KEEP - 1 + N_REFILL) printf("  (unexpected: %ld keys lost)\n", missing);
+
+    printf("  %-22s %8.2f ms   %8zu KB after the drain\n", label, elapsed * 1e3, low / 1024);
+    misc_htable_destroy(ht);
+}
+
+int main()
+{
+    // +--------------------------------------------------------+
+    // | reserve for a burst, drain to a few keys, then refill: |
+    // | shrink in one go against incremental shrink            |
+    // +--------------------------------------------------------+
+
+    printf("reserve %d, keep %d, refill %d\n", N_PEAK, N_KEEP - 1, N_REFILL);
+    run("no shrink", MISC_HTABLE_DEFAULT);
+    run("SHRINK", MISC_HTABLE_SHRINK);
+    run("INCREMENTAL | SHRINK", MISC_HTABLE_INCREMENTAL | MISC_HTABLE_SHRINK);
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "misc/htable.h"
+
+#define N_KEYS    20000
+#define N_LOOKUPS 4000000
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static size_t u64_hash(const void *key)
+{
+    return (size_t)(*(const uint64_t*)key);
+}
+
+static int u64_cmp(const void *a, const void *b)
+{
+    return *(const uint64_t*)a != *(const uint64_t*)b;
+}
+
+static double bench_lookups(misc_htable ht, const uint64_t *keys, const int *order)
+{
+    for (int i = 0; i < N_KEYS; i++)
+    {
+        misc_htable_put(ht, &keys[i], &i);
+    }
+
+    double start = now_sec();
+    long hits = 0;
+    for (int i = 0; i < N_LOOKUPS; i++)
+    {
+        hits += misc_htable_get(ht, &keys[order[i]]) != NULL;
+    }
+    double elapsed = now_sec() - start;
+
+    if (hits != N_LOOKUPS) printf("  (unexpected: %ld hits)\n", hits);
+    misc_htable_destroy(ht);
+    return N_LOOKUPS / elapsed / 1e6;
+}
+
+int main()
+{
+    // +-------------------------------------------------------------+
+    // | lookup throughput on 64-bit keys: the built-in u64 table    |
+    // | against the same table built from user callbacks            |
+    // +-------------------------------------------------------------+
+
+    srand(42);
+
+    uint64_t *keys = (uint64_t*)malloc(N_KEYS * sizeof(uint64_t));
+    int *order = (int*)malloc(N_LOOKUPS * sizeof(int));
+
+    for (int i = 0; i < N_KEYS; i++)
+    {
+        keys[i] = ((uint64_t)rand() << 32) ^ ((uint64_t)i << 8) ^ (uint64_t)rand();
+    }
+
+    for (int i = 0; i < N_LOOKUPS; i++)
+    {
+        order[i] = rand() % N_KEYS;
+    }
+
+    int flags[] = { MISC_HTABLE_DEFAULT, MISC_HTABLE_GROUP_PROBE };
+    const char *names[] = { "scalar", "group" };
+
+    printf("%d uint64_t keys, %d lookups (Mlookups/s)\n", N_KEYS, N_LOOKUPS);
+    for (int f = 0; f < 2; f++)
+    {
+        double custom = bench_lookups(misc_htable_create(sizeof(int), sizeof(uint64_t),
+                                                         u64_hash, u64_cmp, flags[f]), keys, order);
+        double builtin = bench_lookups(misc_htable_create_u64(sizeof(int), flags[f]), keys, order);
+
+        printf("  %-6s  callbacks %6.2f   create_u64 %6.2f\n", names[f], custom, builtin);
+    }
+
+    free(keys);
+    free(order);
+    return 0;
+}
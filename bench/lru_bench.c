@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "misc/htable.h"
+#include "misc/list.h"
+#include "misc/lru.h"
+
+#define CAPACITY   256
+#define N_KEYS     1024
+#define N_REQUESTS 50000
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Skewed keys: half the requests go to a tenth of the key space */
+static int next_key(void)
+{
+    return rand() % 2 ? rand() % (N_KEYS / 10) : rand() % N_KEYS;
+}
+
+static size_t _list_find(const misc_list list, int key)
+{
+    for (size_t i = 0; i < misc_list_size(list); i++)
+    {
+        if (*(int*)misc_list_get(list, i) == key) return i;
+    }
+    return misc_list_size(list);
+}
+
+int main()
+{
+    // +----------------------------------------------------------+
+    // | cache in front of a backend: misc_htable + misc_list     |
+    // | assembled by hand, against misc_lru and its CLOCK policy |
+    // +----------------------------------------------------------+
+
+    srand(42);
+
+    int *requests = (int*)malloc(N_REQUESTS * sizeof(int));
+    for (int i = 0; i < N_REQUESTS; i++) requests[i] = next_key();
+
+    /* misc_htable + misc_list, most recent key at the front */
+    double start = now_sec();
+    misc_htable ht = misc_htable_create_int(sizeof(int), MISC_HTABLE_DEFAULT);
+    misc_list order = misc_list_create(sizeof(int));
+    size_t list_hits = 0;
+    for (int i = 0; i < N_REQUESTS; i++)
+    {
+        int key = requests[i];
+        if (misc_htable_get(ht, &key) != NULL)
+        {
+            list_hits++;
+            misc_list_remove(order, _list_find(order, key), NULL);
+            misc_list_pushfront(order, &key);
+            continue;
+        }
+
+        if (misc_list_size(order) == CAPACITY)
+        {
+            int victim;
+            misc_list_popback(order, &victim);
+            misc_htable_remove(ht, &victim);
+        }
+
+        int value = key * 2;
+        misc_htable_put(ht, &key, &value);
+        misc_list_pushfront(order, &key);
+    }
+    double list_time = now_sec() - start;
+
+    misc_list_destroy(order);
+    misc_htable_destroy(ht);
+
+    size_t hits[2];
+    double times[2];
+    int policies[2] = { MISC_LRU_DEFAULT, MISC_LRU_CLOCK };
+
+    for (int p = 0; p < 2; p++)
+    {
+        start = now_sec();
+        misc_lru cache = misc_lru_create_int(sizeof(int), CAPACITY, policies[p]);
+        for (int i = 0; i < N_REQUESTS; i++)
+        {
+            int key = requests[i];
+            if (misc_lru_get(cache, &key) != NULL) continue;
+
+            int value = key * 2;
+            misc_lru_put(cache, &key, &value);
+        }
+        times[p] = now_sec() - start;
+        hits[p] = misc_lru_hits(cache);
+
+        misc_lru_destroy(cache);
+    }
+
+    if (hits[0] != list_hits) printf("  (unexpected: hit counts differ)\n");
+
+    printf("capacity %d, %d keys, %d requests\n", CAPACITY, N_KEYS, N_REQUESTS);
+    printf("  htable + misc_list    %8.2f ms   hit rate %5.1f%%\n",
+           list_time * 1e3, 100.0 * list_hits / N_REQUESTS);
+    printf("  misc_lru              %8.2f ms   hit rate %5.1f%%\n",
+           times[0] * 1e3, 100.0 * hits[0] / N_REQUESTS);
+    printf("  misc_lru (CLOCK)      %8.2f ms   hit rate %5.1f%%\n",
+           times[1] * 1e3, 100.0 * hits[1] / N_REQUESTS);
+
+    free(requests);
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <malloc.h>
+#include "misc/vector.h"
+#include "misc/smallvec.h"
+
+#define N_VECS   1000000
+#define N_INLINE 4
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static size_t heap_bytes(void)
+{
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+/* Lengths of per-key value lists: mostly 1 to 3, now and then a longer one */
+static int list_length(int i)
+{
+    return i % 100 == 0 ? 20 : 1 + i % 3;
+}
+
+int main()
+{
+    // +------------------------------------------------------+
+    // | a million tiny value lists: misc_vector against      |
+    // | misc_smallvec with 4 inline elements                 |
+    // +------------------------------------------------------+
+
+    misc_vector *vecs = (misc_vector*)malloc(N_VECS * sizeof(misc_vector));
+    misc_smallvec *svecs = (misc_smallvec*)malloc(N_VECS * sizeof(misc_smallvec));
+
+    size_t base = heap_bytes();
+    double start = now_sec();
+    for (int i = 0; i < N_VECS; i++)
+    {
+        vecs[i] = misc_vector_create(sizeof(int));
+        for (int k = 0; k < list_length(i); k++) misc_vector_pushback(vecs[i], &k);
+    }
+    double vec_build = now_sec() - start;
+    size_t vec_bytes = heap_bytes() - base;
+
+    long vec_sum = 0;
+    start = now_sec();
+    for (int i = 0; i < N_VECS; i++)
+    {
+        size_t n = misc_vector_length(vecs[i]);
+        for (size_t k = 0; k < n; k++) vec_sum += *(int*)misc_vector_get(vecs[i], k);
+    }
+    double vec_scan = now_sec() - start;
+
+    for (int i = 0; i < N_VECS; i++) misc_vector_destroy(vecs[i]);
+
+    base = heap_bytes();
+    start = now_sec();
+    for (int i = 0; i < N_VECS; i++)
+    {
+        svecs[i] = misc_smallvec_create(sizeof(int), N_INLINE);
+        for (int k = 0; k < list_length(i); k++) misc_smallvec_pushback(svecs[i], &k);
+    }
+    double svec_build = now_sec() - start;
+    size_t svec_bytes = heap_bytes() - base;
+
+    long svec_sum = 0;
+    start = now_sec();
+    for (int i = 0; i < N_VECS; i++)
+    {
+        size_t n = misc_smallvec_length(svecs[i]);
+        for (size_t k = 0; k < n; k++) svec_sum += *(int*)misc_smallvec_get(svecs[i], k);
+    }
+    double svec_scan = now_sec() - start;
+
+    for (int i = 0; i < N_VECS; i++) misc_smallvec_destroy(svecs[i]);
+
+    if (vec_sum != svec_sum) printf("  (unexpected: sums differ)\n");
+
+    printf("%d vectors of 1-3 ints (1%% of 20)\n", N_VECS);
+    printf("  misc_vector      build %8.2f ms   scan %8.2f ms   heap %8.1f MB\n",
+           vec_build * 1e3, vec_scan * 1e3, vec_bytes / 1e6);
+    printf("  misc_smallvec    build %8.2f ms   scan %8.2f ms   heap %8.1f MB\n",
+           svec_build * 1e3, svec_scan * 1e3, svec_bytes / 1e6);
+
+    free(vecs);
+    free(svecs);
+    return 0;
+}
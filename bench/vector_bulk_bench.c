@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "misc/vector.h"
+
+#define N_BASE    100000
+#define N_CHUNK   4096
+#define N_CHUNKS  256
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main()
+{
+    // +-------------------------------------------------------+
+    // | filling and splicing a vector one element at a time   |
+    // | against pushback_n, insert_n and remove_range         |
+    // +-------------------------------------------------------+
+
+    int *chunk = (int*)malloc(N_CHUNK * sizeof(int));
+    for (int i = 0; i < N_CHUNK; i++) chunk[i] = i;
+
+    /* append N_CHUNKS network-buffer sized chunks */
+    double start = now_sec();
+    misc_vector one = misc_vector_create(sizeof(int));
+    for (int c = 0; c < N_CHUNKS; c++)
+    {
+        for (int i = 0; i < N_CHUNK; i++) misc_vector_pushback(one, &chunk[i]);
+    }
+    double append_one = now_sec() - start;
+
+    start = now_sec();
+    misc_vector bulk = misc_vector_create(sizeof(int));
+    for (int c = 0; c < N_CHUNKS; c++)
+    {
+        misc_vector_pushback_n(bulk, chunk, N_CHUNK);
+    }
+    double append_bulk = now_sec() - start;
+
+    misc_vector_resize(one, N_BASE, NULL);
+    misc_vector_resize(bulk, N_BASE, NULL);
+
+    /* splice a chunk into the middle, then take it out again */
+    start = now_sec();
+    for (int i = 0; i < N_CHUNK; i++) misc_vector_insert(one, N_BASE / 2 + i, &chunk[i]);
+    for (int i = 0; i < N_CHUNK; i++) misc_vector_remove(one, N_BASE / 2, NULL);
+    double splice_one = now_sec() - start;
+
+    start = now_sec();
+    misc_vector_insert_n(bulk, N_BASE / 2, chunk, N_CHUNK);
+    misc_vector_remove_range(bulk, N_BASE / 2, N_CHUNK, NULL);
+    double splice_bulk = now_sec() - start;
+
+    printf("append %d x %d ints, splice %d ints into %d\n", N_CHUNKS, N_CHUNK, N_CHUNK, N_BASE);
+    printf("  one at a time    append %8.2f ms   splice %8.3f ms\n", append_one * 1e3, splice_one * 1e3);
+    printf("  bulk             append %8.2f ms   splice %8.3f ms\n", append_bulk * 1e3, splice_bulk * 1e3);
+
+    misc_vector_destroy(one);
+    misc_vector_destroy(bulk);
+    free(chunk);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "misc/vector.h"
+
+#define N_ELEMS (64 * 1024 * 1024)
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*
+ * The pushback misc_vector used to have, growing into a fresh block with a
+ * full copy; kept out of line so it pays the same call and memcpy as the
+ * library function.
+ */
+typedef struct OldVector
+{
+    void *data;
+    size_t length;
+    size_t capacity;
+    size_t elem_size;
+} OldVector;
+
+__attribute__((noinline))
+static int old_pushback(OldVector *vec, const void *elem)
+{
+    if (vec->length == vec->capacity)
+    {
+        size_t new_cap = vec->capacity * 2;
+        void *new_data = malloc(new_cap * vec->elem_size);
+        if (new_data == NULL) return 0;
+
+        memcpy(new_data, vec->data, vec->length * vec->elem_size);
+        free(vec->data);
+        vec->data = new_data;
+        vec->capacity = new_cap;
+    }
+
+    memcpy((char*)vec->data + vec->length * vec->elem_size, elem, vec->elem_size);
+    vec->length++;
+    return 1;
+}
+
+static double push_malloc_copy(void)
+{
+    double start = now_sec();
+
+    OldVector vec = { malloc(DEFAULT_CAPACITY * sizeof(int)), 0, DEFAULT_CAPACITY, sizeof(int) };
+    for (int i = 0; i < N_ELEMS; i++)
+    {
+        old_pushback(&vec, &i);
+    }
+
+    double elapsed = now_sec() - start;
+    free(vec.data);
+    return elapsed;
+}
+
+static double push_vector(double factor, int reserve)
+{
+    double start = now_sec();
+
+    misc_vector vec = misc_vector_create(sizeof(int));
+    misc_vector_set_growth_factor(vec, factor);
+    if (reserve) misc_vector_reserve(vec, N_ELEMS);
+
+    for (int i = 0; i < N_ELEMS; i++)
+    {
+        misc_vector_pushback(vec, &i);
+    }
+
+    double elapsed = now_sec() - start;
+    misc_vector_destroy(vec);
+    return elapsed;
+}
+
+int main()
+{
+    // +-----------------------------------------------------------+
+    // | filling a 256 MB vector: malloc + memcpy + free doubling  |
+    // | against realloc growth, other factors and a reserve       |
+    // +-----------------------------------------------------------+
+
+    printf("%d int pushbacks\n", N_ELEMS);
+    printf("  malloc + copy, x2      %8.2f ms\n", push_malloc_copy() * 1e3);
+    printf("  realloc, x2            %8.2f ms\n", push_vector(2.0, 0) * 1e3);
+    printf("  realloc, x1.5          %8.2f ms\n", push_vector(1.5, 0) * 1e3);
+    printf("  reserve upfront        %8.2f ms\n", push_vector(2.0, 1) * 1e3);
+
+    return 0;
+}
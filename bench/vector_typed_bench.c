@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "misc/vector.h"
+#include "misc/vector_typed.h"
+
+#define N_ELEMS  (16 * 1024 * 1024)
+#define N_PASSES 8
+
+MISC_VECTOR_DEFINE(int)
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main()
+{
+    // +-------------------------------------------------------+
+    // | summing a vector of ints: misc_vector_get against the |
+    // | MISC_VECTOR_DEFINE(int) accessors and a plain array   |
+    // +-------------------------------------------------------+
+
+    misc_vector generic = misc_vector_create_with_capacity(sizeof(int), N_ELEMS);
+    misc_vector_int typed = misc_vector_int_create_with_capacity(N_ELEMS);
+    int *array = (int*)malloc(N_ELEMS * sizeof(int));
+
+    for (int i = 0; i < N_ELEMS; i++)
+    {
+        int v = i & 0xFF;
+        misc_vector_pushback(generic, &v);
+        misc_vector_int_pushback(typed, v);
+        array[i] = v;
+    }
+
+    long sums[3] = { 0, 0, 0 };
+    double times[3];
+
+    double start = now_sec();
+    for (int p = 0; p < N_PASSES; p++)
+    {
+        size_t n = misc_vector_length(generic);
+        for (size_t i = 0; i < n; i++) sums[0] += *(int*)misc_vector_get(generic, i);
+    }
+    times[0] = now_sec() - start;
+
+    start = now_sec();
+    for (int p = 0; p < N_PASSES; p++)
+    {
+        size_t n = misc_vector_int_length(typed);
+        for (size_t i = 0; i < n; i++) sums[1] += misc_vector_int_get(typed, i);
+    }
+    times[1] = now_sec() - start;
+
+    start = now_sec();
+    for (int p = 0; p < N_PASSES; p++)
+    {
+        for (size_t i = 0; i < N_ELEMS; i++) sums[2] += array[i];
+    }
+    times[2] = now_sec() - start;
+
+    if (sums[0] != sums[1] || sums[1] != sums[2]) printf("  (unexpected: sums differ)\n");
+
+    double total = (double)N_ELEMS * N_PASSES;
+    printf("%d passes over %d ints\n", N_PASSES, N_ELEMS);
+    printf("  misc_vector_get         %8.2f ms   %6.2f Gelem/s\n", times[0] * 1e3, total / times[0] / 1e9);
+    printf("  misc_vector_int_get     %8.2f ms   %6.2f Gelem/s\n", times[1] * 1e3, total / times[1] / 1e9);
+    printf("  plain array             %8.2f ms   %6.2f Gelem/s\n", times[2] * 1e3, total / times[2] / 1e9);
+
+    misc_vector_destroy(generic);
+    misc_vector_int_destroy(typed);
+    free(array);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <pthread.h>
+#include "misc/chtable.h"
+
+#define N_THREADS 4
+#define N_PER_THREAD 1000
+
+typedef struct Worker
+{
+    misc_chtable squares;
+    int first;
+} Worker;
+
+static void* fill_range(void *arg)
+{
+    Worker *w = (Worker*)arg;
+
+    for (int n = w->first; n < w->first + N_PER_THREAD; n++)
+    {
+        long square = (long)n * n;
+        misc_chtable_put(w->squares, &n, &square);
+    }
+
+    return NULL;
+}
+
+int main()
+{
+    // +---------------------------------------------+
+    // | fill a shared table of squares from several |
+    // | threads, each one handling its own range    |
+    // +---------------------------------------------+
+
+    misc_chtable squares = misc_chtable_create_int(sizeof(long), 8, MISC_HTABLE_DEFAULT);
+    if (squares == NULL)
+    {
+        printf("misc_chtable handle allocation failed. Exiting...\n");
+        return 1;
+    }
+
+    pthread_t threads[N_THREADS];
+    Worker workers[N_THREADS];
+    for (int i = 0; i < N_THREADS; i++)
+    {
+        workers[i].squares = squares;
+        workers[i].first = i * N_PER_THREAD;
+        pthread_create(&threads[i], NULL, fill_range, &workers[i]);
+    }
+    for (int i = 0; i < N_THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    printf("Entries: %zu\n", misc_chtable_size(squares));
+
+    int queries[] = {7, 1234, 3999, 4000};
+    for (int i = 0; i < 4; i++)
+    {
+        long square;
+        if (misc_chtable_get(squares, &queries[i], &square))
+            printf("  %d^2 = %ld\n", queries[i], square);
+        else
+            printf("  %d not found\n", queries[i]);
+    }
+
+    misc_chtable_destroy(squares);
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include "misc/htable.h"
+#include "misc/fhtable.h"
+
+#define TABLE_PATH "capitals.fht"
+
+int main()
+{
+    // +--------------------------------------------------+
+    // | build a lookup table once, freeze it to a file,  |
+    // | then map the file and query it in place          |
+    // +--------------------------------------------------+
+
+    const char *countries[] = { "Italy", "France", "Japan", "Kenya", "Peru" };
+    const char *capitals[] = { "Rome", "Paris", "Tokyo", "Nairobi", "Lima" };
+    int n = 5;
+
+    misc_htable table = misc_htable_create_str(16, MISC_HTABLE_DEFAULT);
+    if (table == NULL)
+    {
+        printf("misc_htable handle allocation failed. Exiting...\n");
+        return 1;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        char capital[16];
+        snprintf(capital, sizeof(capital), "%s", capitals[i]);
+        misc_htable_put(table, &countries[i], capital);
+    }
+
+    if (!misc_htable_freeze(table, TABLE_PATH))
+    {
+        printf("Could not write %s. Exiting...\n", TABLE_PATH);
+        misc_htable_destroy(table);
+        return 1;
+    }
+    misc_htable_destroy(table);
+
+    misc_fhtable frozen = misc_fhtable_open(TABLE_PATH, NULL, NULL);
+    if (frozen == NULL)
+    {
+        printf("Could not open %s. Exiting...\n", TABLE_PATH);
+        return 1;
+    }
+
+    printf("%zu entries mapped from %s\n", misc_fhtable_size(frozen), TABLE_PATH);
+
+    const char *queries[] = { "Japan", "Peru", "Spain" };
+    for (int i = 0; i < 3; i++)
+    {
+        const char *capital = (const char*)misc_fhtable_get(frozen, &queries[i]);
+        printf("  '%s' -> %s\n", queries[i], capital != NULL ? capital : "(not found)");
+    }
+
+    misc_fhtable_close(frozen);
+    remove(TABLE_PATH);
+    return 0;
+}
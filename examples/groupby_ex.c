@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include "misc/groupby.h"
+
+typedef struct Sale
+{
+    const char *city;
+    double amount;
+} Sale;
+
+typedef struct Summary
+{
+    double total;
+    double largest;
+    int count;
+} Summary;
+
+static const void* sale_city(const void *record)
+{
+    return &((const Sale*)record)->city;
+}
+
+static void summarize(void *acc, const void *record, int first, void *ctx)
+{
+    (void)ctx;
+
+    Summary *summary = (Summary*)acc;
+    const Sale *sale = (const Sale*)record;
+
+    if (first || sale->amount > summary->largest) summary->largest = sale->amount;
+    summary->total += sale->amount;
+    summary->count++;
+}
+
+static void print_summary(const void *key, void *value, void *ctx)
+{
+    (void)ctx;
+
+    const Summary *summary = (const Summary*)value;
+    printf("  %-6s %d sales, total %7.2f, largest %6.2f\n",
+           *(const char**)key, summary->count, summary->total, summary->largest);
+}
+
+int main()
+{
+    // +------------------------------------------------+
+    // | summarize sales per city with 4 threads        |
+    // +------------------------------------------------+
+
+    Sale sales[] = {
+        { "Rome", 12.50 }, { "Milan", 40.00 }, { "Rome", 7.25 },
+        { "Turin", 19.90 }, { "Milan", 3.10 }, { "Rome", 55.00 },
+        { "Turin", 8.00 }, { "Naples", 21.00 },
+    };
+
+    misc_vector vec = misc_vector_create(sizeof(Sale));
+    misc_htable by_city = misc_htable_create_str(sizeof(Summary), MISC_HTABLE_DEFAULT);
+    if (vec == NULL || by_city == NULL)
+    {
+        printf("handle allocation failed. Exiting...\n");
+        misc_vector_destroy(vec);
+        misc_htable_destroy(by_city);
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(sales) / sizeof(sales[0]); i++)
+    {
+        misc_vector_pushback(vec, &sales[i]);
+    }
+
+    if (misc_groupby(vec, by_city, sale_city, summarize, NULL, 4))
+    {
+        printf("%zu cities\n", misc_htable_size(by_city));
+        misc_htable_foreach(by_city, print_summary, NULL);
+    }
+
+    misc_htable_destroy(by_city);
+    misc_vector_destroy(vec);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include "misc/hmultimap.h"
+
+int main()
+{
+    // +------------------------------------------------+
+    // | build an inverted index: word -> line numbers  |
+    // +------------------------------------------------+
+
+    const char *lines[][4] = {
+        { "the", "quick", "brown", "fox" },
+        { "the", "lazy", "dog", "sleeps" },
+        { "a", "quick", "dog", "runs" },
+    };
+    int n_lines = 3;
+
+    misc_hmultimap index = misc_hmultimap_create_str(sizeof(int), MISC_HTABLE_DEFAULT);
+    if (index == NULL)
+    {
+        printf("misc_hmultimap handle allocation failed. Exiting...\n");
+        return 1;
+    }
+
+    for (int line = 0; line < n_lines; line++)
+    {
+        for (int w = 0; w < 4; w++)
+        {
+            misc_hmultimap_add(index, &lines[line][w], &line);
+        }
+    }
+
+    printf("%zu words, %zu postings\n", misc_hmultimap_key_count(index), misc_hmultimap_size(index));
+
+    const char *queries[] = { "the", "quick", "dog", "cat" };
+    for (int q = 0; q < 4; q++)
+    {
+        const int *postings;
+        size_t count;
+        misc_hmultimap_get_all(index, &queries[q], (const void**)&postings, &count);
+
+        printf("  '%s' ->", queries[q]);
+        for (size_t i = 0; i < count; i++)
+        {
+            printf(" %d", postings[i]);
+        }
+        printf("%s\n", count == 0 ? " (none)" : "");
+    }
+
+    int first = 0;
+    const char *word = "the";
+    misc_hmultimap_remove_one(index, &word, &first);
+    printf("after removing line 0 from 'the': %zu postings\n", misc_hmultimap_size(index));
+
+    misc_hmultimap_destroy(index);
+    return 0;
+}
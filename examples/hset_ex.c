@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include "misc/hset.h"
+
+static void print_set(const char *label, misc_hset set)
+{
+    misc_hset_iter it;
+    const void *key;
+
+    printf("%s (%zu):", label, misc_hset_size(set));
+    misc_hset_iter_begin(set, &it);
+    while (misc_hset_iter_next(&it, &key))
+    {
+        printf(" %s", *(const char**)key);
+    }
+    printf("\n");
+}
+
+int main()
+{
+    // +-----------------------------------------------+
+    // | deduplicate words, then combine two word sets |
+    // +-----------------------------------------------+
+
+    const char *text[] = { "the", "cat", "sat", "on", "the", "mat", "the", "end" };
+    const char *other[] = { "a", "cat", "on", "a", "hat" };
+
+    misc_hset words = misc_hset_create_str(MISC_HTABLE_DEFAULT);
+    misc_hset others = misc_hset_create_str(MISC_HTABLE_DEFAULT);
+
+    for (size_t i = 0; i < sizeof(text) / sizeof(text[0]); i++)
+    {
+        int added;
+        misc_hset_add(words, &text[i], &added);
+        if (!added) printf("duplicate: %s\n", text[i]);
+    }
+
+    for (size_t i = 0; i < sizeof(other) / sizeof(other[0]); i++)
+    {
+        misc_hset_add(others, &other[i], NULL);
+    }
+
+    misc_hset all = misc_hset_union(words, others);
+    misc_hset both = misc_hset_intersection(words, others);
+    misc_hset only = misc_hset_difference(words, others);
+
+    print_set("words", words);
+    print_set("union", all);
+    print_set("intersection", both);
+    print_set("difference", only);
+
+    misc_hset_destroy(all);
+    misc_hset_destroy(both);
+    misc_hset_destroy(only);
+    misc_hset_destroy(words);
+    misc_hset_destroy(others);
+
+    return 0;
+}
@@ -8,7 +8,7 @@ int main()
     // | count word frequency in text |
     // +------------------------------+
 
-    misc_htable word_count = misc_htable_create_str(sizeof(int));
+    misc_htable word_count = misc_htable_create_str(sizeof(int), MISC_HTABLE_DEFAULT);
     if (word_count == NULL)
     {
         printf("misc_htable handle allocation failed. Exiting...\n");
@@ -24,14 +24,9 @@ int main()
         printf("%s ", words[i]);
         
         const char *word = words[i];
-        int *count = (int*)misc_htable_get(word_count, &word);
+        int *count = (int*)misc_htable_get_or_insert(word_count, &word, NULL);
         
-        if (count == NULL)
-        {
-            int c = 1;
-            misc_htable_put(word_count, &word, &c);
-        }
-        else
+        if (count != NULL)
         {
             (*count)++;
         }
@@ -51,6 +46,44 @@ int main()
     }
 
     misc_htable_destroy(word_count);
+
+    // +------------------------------------------------+
+    // | bulk load and query a table owning its keys    |
+    // +------------------------------------------------+
+
+    misc_htable stock = misc_htable_create_str_owned(sizeof(int), MISC_HTABLE_DEFAULT);
+    if (stock == NULL)
+    {
+        printf("misc_htable handle allocation failed. Exiting...\n");
+        return 1;
+    }
+
+    /* The table copies the keys, so they can live in a scratch buffer */
+    char names[4][16];
+    const char *items[4];
+    int quantities[4] = {12, 0, 7, 3};
+    const char *labels[4] = {"apple", "banana", "cherry", "date"};
+    for (int i = 0; i < 4; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "%s", labels[i]);
+        items[i] = names[i];
+    }
+
+    misc_htable_put_many(stock, items, quantities, 4);
+    memset(names, 0, sizeof(names));
+
+    const char *queries[3] = {"cherry", "kiwi", "apple"};
+    void *found[3];
+    size_t hits = misc_htable_get_batch(stock, queries, 3, found);
+
+    printf("\nStock (%zu of 3 found):\n", hits);
+    for (int i = 0; i < 3; i++)
+    {
+        if (found[i] != NULL) printf("  '%s' -> %d\n", queries[i], *(int*)found[i]);
+        else printf("  '%s' -> missing\n", queries[i]);
+    }
+
+    misc_htable_destroy(stock);
     return 0;
 }
 
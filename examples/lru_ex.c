@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include "misc/lru.h"
+
+static int backend_reads = 0;
+
+/* Stands in for a slow lookup, e.g. a database or a remote service */
+static int slow_square(int n)
+{
+    backend_reads++;
+    return n * n;
+}
+
+static void on_evict(const void *key, void *value, void *ctx)
+{
+    (void)ctx;
+    printf("  evicted %d -> %d\n", *(const int*)key, *(int*)value);
+}
+
+int main()
+{
+    // +--------------------------------------------------+
+    // | cache a slow backend behind a 3 entry LRU cache  |
+    // +--------------------------------------------------+
+
+    misc_lru cache = misc_lru_create_int(sizeof(int), 3, MISC_LRU_DEFAULT);
+    if (cache == NULL)
+    {
+        printf("misc_lru handle allocation failed. Exiting...\n");
+        return 1;
+    }
+
+    misc_lru_set_evict(cache, on_evict, NULL);
+
+    int requests[] = { 1, 2, 3, 1, 4, 1, 2, 5, 1 };
+    int n_requests = sizeof(requests) / sizeof(requests[0]);
+
+    for (int i = 0; i < n_requests; i++)
+    {
+        int key = requests[i];
+        int *cached = (int*)misc_lru_get(cache, &key);
+        if (cached != NULL)
+        {
+            printf("%d: hit  -> %d\n", key, *cached);
+            continue;
+        }
+
+        int value = slow_square(key);
+        printf("%d: miss -> %d\n", key, value);
+        misc_lru_put(cache, &key, &value);
+    }
+
+    printf("%zu hits, %zu misses, %zu evictions, %d backend reads\n",
+           misc_lru_hits(cache), misc_lru_misses(cache), misc_lru_evictions(cache), backend_reads);
+
+    misc_lru_destroy(cache);
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include "misc/smallvec.h"
+
+#define N_NODES 5
+
+int main()
+{
+    // +------------------------------------------------+
+    // | adjacency lists of a small graph, most of them |
+    // | fitting in 2 inline slots                      |
+    // +------------------------------------------------+
+
+    int edges[][2] = { {0, 1}, {0, 2}, {1, 2}, {2, 3}, {2, 4}, {2, 0}, {3, 4} };
+    int n_edges = sizeof(edges) / sizeof(edges[0]);
+
+    misc_smallvec adj[N_NODES];
+    for (int i = 0; i < N_NODES; i++)
+    {
+        adj[i] = misc_smallvec_create(sizeof(int), 2);
+        if (adj[i] == NULL)
+        {
+            printf("misc_smallvec handle allocation failed. Exiting...\n");
+            for (int j = 0; j < i; j++) misc_smallvec_destroy(adj[j]);
+            return 1;
+        }
+    }
+
+    for (int e = 0; e < n_edges; e++)
+    {
+        misc_smallvec_pushback(adj[edges[e][0]], &edges[e][1]);
+    }
+
+    for (int i = 0; i < N_NODES; i++)
+    {
+        printf("node %d (%s):", i, misc_smallvec_isinline(adj[i]) ? "inline" : "heap");
+        for (size_t k = 0; k < misc_smallvec_length(adj[i]); k++)
+        {
+            printf(" %d", *(int*)misc_smallvec_get(adj[i], k));
+        }
+        printf("\n");
+
+        misc_smallvec_destroy(adj[i]);
+    }
+
+    return 0;
+}
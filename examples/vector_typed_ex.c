@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include "misc/vector_typed.h"
+
+typedef struct Point
+{
+    double x;
+    double y;
+} Point;
+
+MISC_VECTOR_DEFINE(Point)
+
+int main()
+{
+    // +-----------------------------------------------+
+    // | centroid of a polygon's vertices, stored in a |
+    // | vector generated for the Point type           |
+    // +-----------------------------------------------+
+
+    misc_vector_Point vertices = misc_vector_Point_create();
+    if (vertices == NULL)
+    {
+        printf("misc_vector_Point handle allocation failed. Exiting...\n");
+        return 1;
+    }
+
+    misc_vector_Point_pushback(vertices, (Point){ 0.0, 0.0 });
+    misc_vector_Point_pushback(vertices, (Point){ 4.0, 0.0 });
+    misc_vector_Point_pushback(vertices, (Point){ 4.0, 3.0 });
+    misc_vector_Point_pushback(vertices, (Point){ 0.0, 3.0 });
+
+    Point centroid = { 0.0, 0.0 };
+    size_t n = misc_vector_Point_length(vertices);
+    for (size_t i = 0; i < n; i++)
+    {
+        Point p = misc_vector_Point_get(vertices, i);
+        centroid.x += p.x / n;
+        centroid.y += p.y / n;
+    }
+
+    printf("%zu vertices, centroid (%.2f, %.2f)\n", n, centroid.x, centroid.y);
+
+    misc_vector_Point_destroy(vertices);
+    return 0;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#ifndef CHTABLE_H
+#define CHTABLE_H
+
+#include <stddef.h>
+#include "misc/htable.h"
+
+
+/**
+ * @brief Opaque handle to a concurrent hash table instance.
+ *
+ * The key space is split across independent misc_htable shards, each behind
+ * its own read-write lock, so threads working on different shards never
+ * contend and readers of the same shard proceed in parallel.
+ */
+typedef struct misc_concurrent_hashtable* misc_chtable;
+
+/**
+ * @brief Creates a new concurrent hash table with custom hash and key comparison functions.
+ * @param value_size Size in bytes of each value
+ * @param key_size Size in bytes of each key
+ * @param hash_func Hash function to use for keys
+ * @param key_cmp Key comparison function
+ * @param nshards Number of shards, rounded up to a power of two
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new hash table, or NULL on allocation failure or invalid arguments
+ * @note MISC_HTABLE_INCREMENTAL is not supported, since it makes lookups modify
+ *       the table; sharding already bounds each rehash to a fraction of the entries.
+ */
+misc_chtable misc_chtable_create(size_t value_size, size_t key_size,
+                                 misc_hash_fn hash_func,
+                                 misc_key_cmp_fn key_cmp,
+                                 size_t nshards,
+                                 int flags);
+
+/**
+ * @brief Creates a new concurrent hash table with string keys.
+ * @param value_size Size in bytes of each value
+ * @param nshards Number of shards, rounded up to a power of two
+ * @param flags Hash table configuration flags (see misc_chtable_create)
+ * @return Pointer to the new hash table, or NULL on allocation failure or invalid arguments
+ */
+misc_chtable misc_chtable_create_str(size_t value_size, size_t nshards, int flags);
+
+/**
+ * @brief Creates a new concurrent hash table with integer keys.
+ * @param value_size Size in bytes of each value
+ * @param nshards Number of shards, rounded up to a power of two
+ * @param flags Hash table configuration flags (see misc_chtable_create)
+ * @return Pointer to the new hash table, or NULL on allocation failure or invalid arguments
+ */
+misc_chtable misc_chtable_create_int(size_t value_size, size_t nshards, int flags);
+
+/**
+ * @brief Destroys the hash table and frees all associated memory.
+ * @param ch Hash table to destroy
+ * @warning No other thread may be using the hash table during this call.
+ */
+void misc_chtable_destroy(misc_chtable ch);
+
+/**
+ * @brief Removes all key-value pairs from the hash table.
+ * @param ch Hash table to clear
+ * @note Shards are cleared one at a time, so concurrent insertions may survive.
+ */
+void misc_chtable_clear(misc_chtable ch);
+
+/**
+ * @brief Returns the number of key-value pairs currently stored in the hash table.
+ * @param ch Hash table to query
+ * @return Number of key-value pairs
+ * @note Shards are counted one at a time, so under concurrent updates the
+ *       result is only an approximation.
+ */
+size_t misc_chtable_size(const misc_chtable ch);
+
+/**
+ * @brief Checks if a key exists in the hash table.
+ * @param ch Hash table to query
+ * @param key Pointer to the key to search for
+ * @return 1 if the key is found, 0 otherwise
+ */
+int misc_chtable_contains(const misc_chtable ch, const void *key);
+
+/**
+ * @brief Retrieves a copy of the value associated with a key.
+ * @param ch Hash table to query
+ * @param key Pointer to the key to search for
+ * @param out Pointer where the value will be copied
+ * @return 1 if the key was found, 0 otherwise
+ * @note Unlike misc_htable_get, the value is copied out while the shard is
+ *       locked, since a pointer into the table could be invalidated by
+ *       another thread at any time.
+ */
+int misc_chtable_get(const misc_chtable ch, const void *key, void *out);
+
+/**
+ * @brief Inserts or updates a key-value pair in the hash table.
+ * @param ch Hash table to modify
+ * @param key Pointer to the key
+ * @param value Pointer to the value
+ * @return 1 on success, 0 on allocation failure
+ */
+int misc_chtable_put(misc_chtable ch, const void *key, const void *value);
+
+/**
+ * @brief Removes a key-value pair from the hash table.
+ * @param ch Hash table to modify
+ * @param key Pointer to the key to remove
+ * @return 1 if the key was found and removed, 0 otherwise
+ */
+int misc_chtable_remove(misc_chtable ch, const void *key);
+
+#endif /* CHTABLE_H */
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef FHTABLE_H
+#define FHTABLE_H
+
+#include <stddef.h>
+#include "misc/htable.h"
+
+
+/**
+ * @brief Opaque handle to a frozen hash table.
+ *
+ * A frozen table is a file written by misc_htable_freeze and mapped read-only
+ * into memory. Lookups read the mapping directly, without loading or
+ * allocating anything, and processes opening the same file share its pages.
+ */
+typedef struct misc_frozen_hashtable* misc_fhtable;
+
+/**
+ * @brief Opens a frozen hash table.
+ * @param path Path of a file written by misc_htable_freeze
+ * @param hash_func Hash function of the source table, for tables with custom
+ *                  keys; NULL for string and integer keys
+ * @param key_cmp Key comparison function of the source table, for tables with
+ *                custom keys; NULL for string and integer keys
+ * @return Handle to the frozen table, or NULL if the file cannot be mapped, is
+ *         not a valid frozen table, or needs functions that were not given
+ * @note Keys are passed to lookups in the same form as to the source table
+ *       (e.g. a pointer to a char* for string keys).
+ */
+misc_fhtable misc_fhtable_open(const char *path, misc_hash_fn hash_func, misc_key_cmp_fn key_cmp);
+
+/**
+ * @brief Unmaps a frozen hash table.
+ * @param ft Frozen table to close
+ * @note Pointers returned by misc_fhtable_get become invalid.
+ */
+void misc_fhtable_close(misc_fhtable ft);
+
+/**
+ * @brief Returns the number of entries in the frozen table.
+ * @param ft Frozen table to query
+ * @return Number of entries, or 0 if ft is NULL
+ */
+size_t misc_fhtable_size(const misc_fhtable ft);
+
+/**
+ * @brief Retrieves the value associated with a key.
+ * @param ft Frozen table to search
+ * @param key Pointer to the key
+ * @return Pointer to the value inside the mapping, or NULL if the key is not found
+ * @warning The value is read-only; the mapping is not writable.
+ */
+const void* misc_fhtable_get(const misc_fhtable ft, const void *key);
+
+/**
+ * @brief Checks if a key exists in the frozen table.
+ * @param ft Frozen table to search
+ * @param key Pointer to the key
+ * @return 1 if the key exists, 0 otherwise
+ */
+int misc_fhtable_contains(const misc_fhtable ft, const void *key);
+
+#endif
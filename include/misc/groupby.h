@@ -0,0 +1,53 @@
+#pragma once
+#ifndef GROUPBY_H
+#define GROUPBY_H
+
+#include <stddef.h>
+#include "misc/htable.h"
+#include "misc/vector.h"
+
+
+/**
+ * @brief Key extraction function type for misc_groupby.
+ * @param record Pointer to a record of the vector
+ * @return Pointer to the record's key, in the layout of the output table's keys
+ *         (e.g. a pointer to a char* field for a string keyed table)
+ * @note Called concurrently, possibly more than once per record.
+ */
+typedef const void* (*misc_groupby_key_fn)(const void *record);
+
+/**
+ * @brief Aggregation function type for misc_groupby.
+ * @param acc Pointer to the accumulator of the record's group, i.e. its value
+ *            in the output table
+ * @param record Pointer to the record being folded in
+ * @param first 1 if record is the first of its group, 0 otherwise
+ * @param ctx User context passed to misc_groupby
+ * @note The accumulator of a new group is zero-filled before the first call.
+ * @note Called concurrently, but never on the same group from two threads.
+ */
+typedef void (*misc_groupby_agg_fn)(void *acc, const void *record, int first, void *ctx);
+
+/**
+ * @brief Groups the records of a vector by key and folds each group into an accumulator.
+ * @param vec Vector of records
+ * @param out Empty hash table receiving one entry per group, mapping the key
+ *            to its accumulator; its key kind, hash functions and flags are
+ *            used for the per-thread tables as well
+ * @param key_fn Function returning the key of a record
+ * @param agg_fn Function folding a record into the accumulator of its group
+ * @param ctx User context passed to agg_fn
+ * @param nthreads Number of threads to use (including the caller)
+ * @return 1 on success, 0 on allocation failure or invalid arguments
+ * @note Records are partitioned by key hash, so each group is aggregated by a
+ *       single thread into its own table, and the tables are merged into out
+ *       without locking. Within a group, records are folded in vector order.
+ * @note On failure out is left empty.
+ */
+int misc_groupby(const misc_vector vec, misc_htable out,
+                 misc_groupby_key_fn key_fn,
+                 misc_groupby_agg_fn agg_fn,
+                 void *ctx,
+                 size_t nthreads);
+
+#endif
@@ -0,0 +1,142 @@
+#pragma once
+#ifndef HMULTIMAP_H
+#define HMULTIMAP_H
+
+#include <stddef.h>
+#include "misc/htable.h"
+
+
+/**
+ * @brief Opaque handle to a hash multimap instance.
+ *
+ * Each key maps to a run of values kept contiguous in memory, in insertion
+ * order. The run's bookkeeping lives inline in the key's hash table slot, so
+ * reaching the values of a key costs one lookup and one pointer.
+ */
+typedef struct misc_generic_hmultimap* misc_hmultimap;
+
+/**
+ * @brief Visitor function type for misc_hmultimap_foreach.
+ * @param key Pointer to the key
+ * @param values Pointer to the first value of the key's run
+ * @param count Number of values in the run
+ * @param ctx User context passed to the foreach call
+ */
+typedef void (*misc_hmultimap_visit_fn)(const void *key, const void *values, size_t count, void *ctx);
+
+/**
+ * @brief Creates a new hash multimap with custom hash and key comparison functions.
+ * @param value_size Size in bytes of each value
+ * @param key_size Size in bytes of each key
+ * @param hash_func Hash function to use for keys
+ * @param key_cmp Key comparison function
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new multimap, or NULL on allocation failure or invalid arguments
+ */
+misc_hmultimap misc_hmultimap_create(size_t value_size, size_t key_size,
+                                     misc_hash_fn hash_func,
+                                     misc_key_cmp_fn key_cmp,
+                                     int flags);
+
+/**
+ * @brief Creates a new hash multimap with string keys owned by the multimap.
+ * @param value_size Size in bytes of each value
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new multimap, or NULL on allocation failure or invalid arguments
+ * @note Keys are passed as a pointer to a char* (see misc_htable_create_str_owned).
+ */
+misc_hmultimap misc_hmultimap_create_str(size_t value_size, int flags);
+
+/**
+ * @brief Creates a new hash multimap with integer keys.
+ * @param value_size Size in bytes of each value
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new multimap, or NULL on allocation failure or invalid arguments
+ */
+misc_hmultimap misc_hmultimap_create_int(size_t value_size, int flags);
+
+/**
+ * @brief Creates a new hash multimap with uint64_t keys.
+ * @param value_size Size in bytes of each value
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new multimap, or NULL on allocation failure or invalid arguments
+ */
+misc_hmultimap misc_hmultimap_create_u64(size_t value_size, int flags);
+
+/**
+ * @brief Destroys the multimap and frees all associated memory.
+ * @param mm Multimap to destroy
+ */
+void misc_hmultimap_destroy(misc_hmultimap mm);
+
+/**
+ * @brief Removes all keys and values from the multimap.
+ * @param mm Multimap to clear
+ */
+void misc_hmultimap_clear(misc_hmultimap mm);
+
+/**
+ * @brief Returns the number of distinct keys in the multimap.
+ * @param mm Multimap to query
+ * @return Number of keys, or 0 if mm is NULL
+ */
+size_t misc_hmultimap_key_count(const misc_hmultimap mm);
+
+/**
+ * @brief Returns the total number of values in the multimap.
+ * @param mm Multimap to query
+ * @return Number of values over all keys, or 0 if mm is NULL
+ */
+size_t misc_hmultimap_size(const misc_hmultimap mm);
+
+/**
+ * @brief Appends a value to the run of a key.
+ * @param mm Multimap to modify
+ * @param key Pointer to the key
+ * @param value Pointer to the value
+ * @return 1 on success, 0 on allocation failure
+ * @note The same value can be added more than once.
+ * @note Runs grow by doubling, like misc_vector.
+ */
+int misc_hmultimap_add(misc_hmultimap mm, const void *key, const void *value);
+
+/**
+ * @brief Retrieves all values of a key.
+ * @param mm Multimap to search
+ * @param key Pointer to the key
+ * @param values Set to the first value of the run, or NULL if the key is not found
+ * @param count Set to the number of values, or 0 if the key is not found
+ * @return 1 if the key was found, 0 otherwise
+ * @warning The run remains valid until the multimap is modified.
+ */
+int misc_hmultimap_get_all(const misc_hmultimap mm, const void *key, const void **values, size_t *count);
+
+/**
+ * @brief Removes the first occurrence of a value from the run of a key.
+ * @param mm Multimap to modify
+ * @param key Pointer to the key
+ * @param value Pointer to the value to remove, compared byte for byte
+ * @return 1 if a value was removed, 0 if the key or value was not found
+ * @note The remaining values keep their order. The key is removed with its
+ *       last value.
+ */
+int misc_hmultimap_remove_one(misc_hmultimap mm, const void *key, const void *value);
+
+/**
+ * @brief Removes a key and all its values.
+ * @param mm Multimap to modify
+ * @param key Pointer to the key
+ * @return 1 if the key was found and removed, 0 otherwise
+ */
+int misc_hmultimap_remove(misc_hmultimap mm, const void *key);
+
+/**
+ * @brief Calls a function on the run of every key.
+ * @param mm Multimap to visit
+ * @param fn Function called with each key, its values and their count
+ * @param ctx User context passed to fn
+ * @warning fn must not modify the multimap.
+ */
+void misc_hmultimap_foreach(const misc_hmultimap mm, misc_hmultimap_visit_fn fn, void *ctx);
+
+#endif
@@ -0,0 +1,166 @@
+#pragma once
+#ifndef HSET_H
+#define HSET_H
+
+#include <stddef.h>
+#include "misc/htable.h"
+
+
+/**
+ * @brief Opaque handle to a hash set instance.
+ *
+ * A set is a misc_htable whose slots hold keys only, so it shares the table's
+ * probing, growth and flags (see misc_htable_create) without storing any
+ * value bytes.
+ */
+typedef struct misc_generic_hashtable* misc_hset;
+
+/**
+ * @brief Cursor over the keys of a hash set.
+ */
+typedef misc_htable_iter misc_hset_iter;
+
+/**
+ * @brief Creates a new hash set with custom hash and key comparison functions.
+ * @param key_size Size in bytes of each key
+ * @param hash_func Hash function to use for keys
+ * @param key_cmp Key comparison function
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new hash set, or NULL on allocation failure
+ */
+misc_hset misc_hset_create(size_t key_size,
+                           misc_hash_fn hash_func,
+                           misc_key_cmp_fn key_cmp,
+                           int flags);
+
+/**
+ * @brief Creates a new hash set of strings.
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new hash set, or NULL on allocation failure
+ * @note Keys are passed as a pointer to a char* and the strings must outlive
+ *       the set, as with misc_htable_create_str.
+ */
+misc_hset misc_hset_create_str(int flags);
+
+/**
+ * @brief Creates a new hash set of strings owned by the set.
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new hash set, or NULL on allocation failure
+ * @note The set keeps its own copy of each string (see misc_htable_create_str_owned).
+ */
+misc_hset misc_hset_create_str_owned(int flags);
+
+/**
+ * @brief Creates a new hash set of integers.
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new hash set, or NULL on allocation failure
+ */
+misc_hset misc_hset_create_int(int flags);
+
+/**
+ * @brief Creates a new hash set of uint64_t values.
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new hash set, or NULL on allocation failure
+ */
+misc_hset misc_hset_create_u64(int flags);
+
+/**
+ * @brief Creates a new hash set of pointers, compared by address.
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new hash set, or NULL on allocation failure
+ */
+misc_hset misc_hset_create_ptr(int flags);
+
+/**
+ * @brief Destroys the hash set and frees all associated memory.
+ * @param set Hash set to destroy
+ */
+void misc_hset_destroy(misc_hset set);
+
+/**
+ * @brief Removes all keys from the hash set.
+ * @param set Hash set to clear
+ */
+void misc_hset_clear(misc_hset set);
+
+/**
+ * @brief Returns the number of keys in the hash set.
+ * @param set Hash set to query
+ * @return Number of keys, or 0 if set is NULL
+ */
+size_t misc_hset_size(const misc_hset set);
+
+/**
+ * @brief Adds a key to the hash set.
+ * @param set Hash set to modify
+ * @param key Pointer to the key
+ * @param added Optional pointer set to 1 if the key was not in the set yet,
+ *              0 otherwise (can be NULL)
+ * @return 1 on success, 0 on allocation failure
+ */
+int misc_hset_add(misc_hset set, const void *key, int *added);
+
+/**
+ * @brief Checks if a key is in the hash set.
+ * @param set Hash set to search
+ * @param key Pointer to the key
+ * @return 1 if the key is in the set, 0 otherwise
+ */
+int misc_hset_contains(const misc_hset set, const void *key);
+
+/**
+ * @brief Removes a key from the hash set.
+ * @param set Hash set to modify
+ * @param key Pointer to the key
+ * @return 1 if the key was removed, 0 if it was not in the set
+ */
+int misc_hset_remove(misc_hset set, const void *key);
+
+/**
+ * @brief Starts an iteration over the keys of the hash set.
+ * @param set Hash set to iterate
+ * @param it Cursor to initialize
+ * @note Same rules as misc_htable_iter_begin.
+ */
+void misc_hset_iter_begin(misc_hset set, misc_hset_iter *it);
+
+/**
+ * @brief Advances the cursor to the next key.
+ * @param it Cursor started with misc_hset_iter_begin
+ * @param key Set to the next key
+ * @return 1 if a key was returned, 0 at the end of the set
+ */
+int misc_hset_iter_next(misc_hset_iter *it, const void **key);
+
+/**
+ * @brief Creates the union of two hash sets.
+ * @param a First set
+ * @param b Second set
+ * @return A new set holding the keys in a or b, or NULL on allocation failure
+ * @warning Both sets must have been created with the same key type.
+ * @note The larger set is copied and the smaller one is added to the copy.
+ */
+misc_hset misc_hset_union(const misc_hset a, const misc_hset b);
+
+/**
+ * @brief Creates the intersection of two hash sets.
+ * @param a First set
+ * @param b Second set
+ * @return A new set holding the keys in both a and b, or NULL on allocation failure
+ * @warning Both sets must have been created with the same key type.
+ * @note Walks the smaller set and probes the larger one.
+ */
+misc_hset misc_hset_intersection(const misc_hset a, const misc_hset b);
+
+/**
+ * @brief Creates the difference of two hash sets.
+ * @param a Set to take keys from
+ * @param b Set of keys to leave out
+ * @return A new set holding the keys in a but not in b, or NULL on allocation failure
+ * @warning Both sets must have been created with the same key type.
+ * @note If a is the smaller set, its keys are probed in b; otherwise a is
+ *       copied and the keys of b are removed from the copy.
+ */
+misc_hset misc_hset_difference(const misc_hset a, const misc_hset b);
+
+#endif
@@ -10,6 +10,44 @@
  */
 typedef struct misc_generic_hashtable* misc_htable;
 
+/**
+ * @brief Flag for creating a hash table with the default settings.
+ */
+#define MISC_HTABLE_DEFAULT     0
+
+/**
+ * @brief Flag for creating a hash table whose lookups probe a whole group of
+ *        slots at once (16 with SSE2, 32 with AVX2 when the CPU supports it),
+ *        calling the key comparison function only on slots whose hash tag matches.
+ */
+#define MISC_HTABLE_GROUP_PROBE 1
+
+/**
+ * @brief Flag for creating a hash table that grows incrementally: instead of
+ *        moving every entry at once, the old and new storage are kept side by
+ *        side and each put/get/contains/remove moves a bounded number of entries.
+ */
+#define MISC_HTABLE_INCREMENTAL 2
+
+/**
+ * @brief Flag for creating a hash table resistant to hash flooding: the table
+ *        draws a random seed at creation and hashes keys of the built-in types
+ *        (string and integer tables) with SipHash-1-3 keyed by it, so colliding
+ *        keys cannot be computed in advance.
+ * @note With a custom hash function, the seed is only mixed into the function's
+ *       output; keys the function itself maps to the same hash still collide.
+ */
+#define MISC_HTABLE_SEEDED      4
+
+/**
+ * @brief Flag for creating a hash table that shrinks when entries are removed:
+ *        once the load drops below a quarter of the maximum load, the table is
+ *        rebuilt to half the maximum load.
+ * @note A removal that shrinks the table invalidates value pointers and ends
+ *       running iterations, like an insertion that grows it.
+ */
+#define MISC_HTABLE_SHRINK      8
+
 /**
  * @brief Hash function type.
  * @param key Pointer to the key to hash
@@ -17,6 +55,13 @@ typedef struct misc_generic_hashtable* misc_htable;
  */
 typedef size_t (*misc_hash_fn)(const void *key);
 
+/**
+ * @brief Hash finalizer type, applied to the output of the hash function.
+ * @param hash Hash value returned by the hash function
+ * @return Mixed hash value
+ */
+typedef size_t (*misc_hash_mix_fn)(size_t hash);
+
 /**
  * @brief Key comparison function type.
  * @param key1 Pointer to first key
@@ -25,34 +70,201 @@ typedef size_t (*misc_hash_fn)(const void *key);
  */
 typedef int (*misc_key_cmp_fn)(const void *key1, const void *key2);
 
+/**
+ * @brief Cursor over the entries of a hash table.
+ * @note The fields are private; use misc_htable_iter_begin and misc_htable_iter_next.
+ */
+typedef struct misc_htable_iter
+{
+    misc_htable ht;
+    const void *slots;
+    size_t idx;
+} misc_htable_iter;
+
+/**
+ * @brief Number of probe-length buckets in misc_htable_stats_info.
+ */
+#define MISC_HTABLE_STATS_BUCKETS 16
+
+/**
+ * @brief Snapshot of a hash table's shape and activity, filled by misc_htable_stats.
+ *
+ * The probe length of an entry is the number of slots a successful lookup
+ * reads to find it: 1 when the entry sits in its home slot. Long probes with
+ * a low load point at the hash function; long probes that only appear at a
+ * high load point at the load factor.
+ */
+typedef struct misc_htable_stats_info
+{
+    size_t capacity;        /**< Slots in the current storage */
+    size_t size;            /**< Number of entries */
+    size_t tombstones;      /**< Slots left behind by removals */
+    double load_factor;     /**< (size + tombstones) / capacity */
+
+    size_t max_probe;       /**< Longest probe length */
+    double mean_probe;      /**< Mean probe length over all entries */
+    size_t max_cluster;     /**< Longest run of consecutive non-empty slots */
+    size_t probe_histogram[MISC_HTABLE_STATS_BUCKETS]; /**< Entries by probe length; [i] counts length i + 1, the last bucket also counts longer probes */
+
+    size_t rehash_count;    /**< Number of times the storage was rebuilt */
+    double rehash_seconds;  /**< Time spent rebuilding the storage */
+
+    size_t lookups;         /**< get/contains calls and get_batch keys (MISC_STATS builds only) */
+    size_t hits;            /**< Lookups that found their key (MISC_STATS builds only) */
+    size_t inserts;         /**< New entries added (MISC_STATS builds only) */
+    size_t removes;         /**< Entries removed (MISC_STATS builds only) */
+} misc_htable_stats_info;
+
+/**
+ * @brief Visitor function type for misc_htable_foreach.
+ * @param key Pointer to the key of the entry
+ * @param value Pointer to the value of the entry, which may be modified
+ * @param ctx User context passed to the foreach call
+ */
+typedef void (*misc_htable_visit_fn)(const void *key, void *value, void *ctx);
+
 /**
  * @brief Creates a new hash table with custom hash and key comparison functions.
- * @param value_size Size in bytes of each value
+ * @param value_size Size in bytes of each value, or 0 for a key-only table
  * @param key_size Size in bytes of each key
  * @param hash_func Hash function to use for keys
  * @param key_cmp Key comparison function
+ * @param flags Hash table configuration flags (can be OR'd together):
+ *              - MISC_HTABLE_DEFAULT: default settings
+ *              - MISC_HTABLE_GROUP_PROBE: SIMD group probing for lookups
+ *              - MISC_HTABLE_INCREMENTAL: incremental rehashing
+ *              - MISC_HTABLE_SEEDED: randomly seeded, keyed hashing
+ *              - MISC_HTABLE_SHRINK: shrink as entries are removed
  * @return Pointer to the new hash table, or NULL on allocation failure
  * @note The caller must provide both a hash function and a comparison function.
  */
 misc_htable misc_htable_create(size_t value_size, size_t key_size, 
                                misc_hash_fn hash_func, 
-                               misc_key_cmp_fn key_cmp);
+                               misc_key_cmp_fn key_cmp,
+                               int flags);
+
+/**
+ * @brief Creates a new hash table with a custom initial capacity and load factor.
+ * @param value_size Size in bytes of each value
+ * @param key_size Size in bytes of each key
+ * @param hash_func Hash function to use for keys
+ * @param key_cmp Key comparison function
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @param initial_capacity Minimum number of slots to allocate upfront
+ * @param max_load Load factor above which the table grows, between 0 and 1 (exclusive)
+ * @return Pointer to the new hash table, or NULL on allocation failure or invalid arguments
+ * @note The capacity is rounded up to a power of two (at least 16). To size the
+ *       table for a known number of entries, use misc_htable_reserve.
+ */
+misc_htable misc_htable_create_ex(size_t value_size, size_t key_size,
+                                  misc_hash_fn hash_func,
+                                  misc_key_cmp_fn key_cmp,
+                                  int flags,
+                                  size_t initial_capacity,
+                                  double max_load);
 
 /**
  * @brief Creates a new hash table with string keys.
  * @param value_size Size in bytes of each value
+ * @param flags Hash table configuration flags (see misc_htable_create)
  * @return Pointer to the new hash table, or NULL on allocation failure
  * @note Uses FNV-1a hash function and strcmp for key comparison.
  */
-misc_htable misc_htable_create_str(size_t value_size);
+misc_htable misc_htable_create_str(size_t value_size, int flags);
+
+/**
+ * @brief Creates a new hash table with string keys owned by the table.
+ * @param value_size Size in bytes of each value
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new hash table, or NULL on allocation failure
+ * @note Keys are passed as with misc_htable_create_str (a pointer to a char*),
+ *       but the table stores its own copy of each string together with its
+ *       length, so the caller's string does not need to outlive the call.
+ * @note Uses a wyhash-style hash that reads 8 bytes at a time, and compares
+ *       lengths before bytes.
+ * @note Keys returned by iteration point to the table's copy and can be read
+ *       as a char* as well.
+ */
+misc_htable misc_htable_create_str_owned(size_t value_size, int flags);
 
 /**
  * @brief Creates a new hash table with integer keys.
  * @param value_size Size in bytes of each value
+ * @param flags Hash table configuration flags (see misc_htable_create)
  * @return Pointer to the new hash table, or NULL on allocation failure
  * @note Uses a specialized integer hash function and integer comparison.
  */
-misc_htable misc_htable_create_int(size_t value_size);
+misc_htable misc_htable_create_int(size_t value_size, int flags);
+
+/**
+ * @brief Creates a new hash table with uint64_t keys.
+ * @param value_size Size in bytes of each value
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new hash table, or NULL on allocation failure
+ * @note Hashing and comparison are inlined into the probe loops; no hash or
+ *       comparison function is called per lookup.
+ */
+misc_htable misc_htable_create_u64(size_t value_size, int flags);
+
+/**
+ * @brief Creates a new hash table with int64_t keys.
+ * @param value_size Size in bytes of each value
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new hash table, or NULL on allocation failure
+ * @note Same as misc_htable_create_u64: keys are compared by their bits.
+ */
+misc_htable misc_htable_create_i64(size_t value_size, int flags);
+
+/**
+ * @brief Creates a new hash table keyed by pointer identity.
+ * @param value_size Size in bytes of each value
+ * @param flags Hash table configuration flags (see misc_htable_create)
+ * @return Pointer to the new hash table, or NULL on allocation failure
+ * @note Keys are passed as a pointer to the pointer (e.g. &ptr), like any
+ *       other key; the address is hashed and compared, never dereferenced.
+ */
+misc_htable misc_htable_create_ptr(size_t value_size, int flags);
+
+/**
+ * @brief Makes room for a given number of entries.
+ * @param ht Hash table to modify
+ * @param n Total number of entries the table must hold without rehashing
+ * @return 1 on success, 0 on allocation failure
+ * @note The table is rebuilt at most once; no rehash happens afterwards until
+ *       it holds more than n entries.
+ */
+int misc_htable_reserve(misc_htable ht, size_t n);
+
+/**
+ * @brief Sets the finalizer applied to every hash before it is used.
+ * @param ht Hash table to modify
+ * @param finalizer Mixing function, or NULL to use the hash function's output as is
+ * @return 1 on success, 0 on allocation failure
+ * @note New hash tables use a splitmix64 finalizer, so that hash functions with
+ *       poorly distributed low or high bits still spread keys across the table.
+ *       Pass NULL only if the hash function is already well mixed; integer keys
+ *       in tables from misc_htable_create_int rely on the finalizer.
+ * @note Existing entries are rehashed with the new finalizer.
+ */
+int misc_htable_set_finalizer(misc_htable ht, misc_hash_mix_fn finalizer);
+
+/**
+ * @brief Creates an empty hash table configured like an existing one.
+ * @param ht Hash table to copy the configuration from
+ * @return Pointer to the new hash table, or NULL on allocation failure
+ * @note Key and value sizes, hash and comparison functions, finalizer, flags
+ *       and maximum load are copied; a seeded table gets a fresh seed.
+ */
+misc_htable misc_htable_create_like(const misc_htable ht);
+
+/**
+ * @brief Creates a copy of a hash table and all its entries.
+ * @param ht Hash table to copy
+ * @return Pointer to the new hash table, or NULL on allocation failure
+ * @note The stores are copied as they are, without rehashing any key. Owned
+ *       string keys are duplicated.
+ */
+misc_htable misc_htable_clone(const misc_htable ht);
 
 /**
  * @brief Destroys the hash table and frees all associated memory.
@@ -69,6 +281,15 @@ void misc_htable_destroy(misc_htable ht);
  */
 void misc_htable_clear(misc_htable ht);
 
+/**
+ * @brief Computes the hash the table uses for a key.
+ * @param ht Hash table to query
+ * @param key Pointer to the key to hash
+ * @return Hash value of the key, with the table's finalizer applied
+ * @note Useful to spread keys across several tables, e.g. for sharding.
+ */
+size_t misc_htable_hash(const misc_htable ht, const void *key);
+
 /**
  * @brief Returns the number of key-value pairs currently stored in the hash table.
  * @param ht Hash table to query
@@ -90,21 +311,62 @@ int misc_htable_contains(const misc_htable ht, const void *key);
  * @param key Pointer to the key to search for
  * @return Pointer to the value if the key exists, NULL otherwise
  * @warning The pointer remains valid until the hash table is modified.
+ * @warning With MISC_HTABLE_INCREMENTAL, lookups also move entries while the
+ *          table is growing, so the pointer is only valid until the next call
+ *          on the hash table.
  */
 void* misc_htable_get(const misc_htable ht, const void *key);
 
+/**
+ * @brief Retrieves the values associated with many keys at once.
+ * @param ht Hash table to query
+ * @param keys Array of n keys, stored contiguously (a char* array for string keyed tables)
+ * @param n Number of keys
+ * @param out_values Array of n pointers, each set to the value of the corresponding key, or NULL if it is missing
+ * @return Number of keys found
+ * @note Keys are hashed in small groups and their slots prefetched before any
+ *       of them is compared, so the memory latency of the lookups overlaps.
+ * @warning The pointers remain valid until the hash table is modified.
+ */
+size_t misc_htable_get_batch(const misc_htable ht, const void *keys, size_t n, void **out_values);
+
 /**
  * @brief Inserts or updates a key-value pair in the hash table.
  * @param ht Hash table to modify
  * @param key Pointer to the key
- * @param value Pointer to the value
+ * @param value Pointer to the value (can be NULL if the value size is 0)
  * @return 1 on success, 0 on allocation failure
  * @note If the key already exists, its value is updated.
  * @note If the key does not exist, a new entry is created.
- * @note Automatically rehashes when the load factor exceeds 0.75.
+ * @note Automatically rehashes when the load factor exceeds 0.75. With
+ *       MISC_HTABLE_INCREMENTAL the rehash is spread over the following operations.
  */
 int misc_htable_put(misc_htable ht, const void *key, const void *value);
 
+/**
+ * @brief Returns the value slot for a key, inserting the key if it is missing.
+ * @param ht Hash table to modify
+ * @param key Pointer to the key
+ * @param inserted Optional pointer set to 1 if the key was inserted, 0 if it was already present (can be NULL)
+ * @return Pointer to the value, or NULL on allocation failure
+ * @note A newly inserted value is zero-filled, so e.g. counters can be
+ *       incremented in place with a single lookup.
+ * @warning The pointer remains valid until the hash table is modified.
+ */
+void* misc_htable_get_or_insert(misc_htable ht, const void *key, int *inserted);
+
+/**
+ * @brief Returns the value slot for a key, inserting the key with an uninitialized value if it is missing.
+ * @param ht Hash table to modify
+ * @param key Pointer to the key
+ * @param inserted Optional pointer set to 1 if the key was inserted, 0 if it was already present (can be NULL)
+ * @return Pointer to the value, or NULL on allocation failure
+ * @note When *inserted is 1 the caller must fill the value in place before the
+ *       next operation on the hash table.
+ * @warning The pointer remains valid until the hash table is modified.
+ */
+void* misc_htable_emplace(misc_htable ht, const void *key, int *inserted);
+
 /**
  * @brief Removes a key-value pair from the hash table.
  * @param ht Hash table to modify
@@ -113,4 +375,102 @@ int misc_htable_put(misc_htable ht, const void *key, const void *value);
  */
 int misc_htable_remove(misc_htable ht, const void *key);
 
+/**
+ * @brief Rebuilds the hash table into the smallest storage that holds its entries.
+ * @param ht Hash table to compact
+ * @return 1 on success, 0 on allocation failure (the table is left unchanged)
+ * @note Also drops all tombstones and finishes any incremental rehash. The
+ *       next insertion may grow the table again.
+ * @warning Invalidates value pointers and running iterations.
+ */
+int misc_htable_compact(misc_htable ht);
+
+/**
+ * @brief Inserts or updates many key-value pairs at once.
+ * @param ht Hash table to modify
+ * @param keys Array of n keys, stored contiguously (a char* array for string keyed tables)
+ * @param values Array of n values, stored contiguously
+ * @param n Number of key-value pairs
+ * @return 1 on success, 0 on allocation failure
+ * @note The table is sized once for all n pairs upfront, so no rehash happens
+ *       while inserting them.
+ * @note On allocation failure, a prefix of the pairs may have been inserted.
+ */
+int misc_htable_put_many(misc_htable ht, const void *keys, const void *values, size_t n);
+
+/**
+ * @brief Starts a cursor over the entries of the hash table.
+ * @param ht Hash table to walk
+ * @param it Cursor to initialize
+ * @note Entries are returned in storage order, which is unrelated to insertion order.
+ * @note The cursor stays valid across updates that do not resize the table:
+ *       changing values, removing entries and inserting into free slots. An
+ *       entry inserted during the walk may or may not be returned. Once the
+ *       table is resized, misc_htable_iter_next returns 0.
+ */
+void misc_htable_iter_begin(misc_htable ht, misc_htable_iter *it);
+
+/**
+ * @brief Advances a cursor to the next entry.
+ * @param it Cursor to advance
+ * @param key Optional pointer set to the entry's key (can be NULL)
+ * @param value Optional pointer set to the entry's value (can be NULL)
+ * @return 1 if an entry was returned, 0 at the end of the table
+ */
+int misc_htable_iter_next(misc_htable_iter *it, void **key, void **value);
+
+/**
+ * @brief Calls a function on every entry of the hash table.
+ * @param ht Hash table to walk
+ * @param fn Function called with each key, value and ctx
+ * @param ctx User context passed to fn
+ * @warning fn may modify values but must not insert or remove entries.
+ */
+void misc_htable_foreach(const misc_htable ht, misc_htable_visit_fn fn, void *ctx);
+
+/**
+ * @brief Calls a function on every entry of the hash table, from several threads.
+ * @param ht Hash table to walk
+ * @param fn Function called with each key, value and ctx
+ * @param ctx User context passed to fn
+ * @param nthreads Number of threads the slot range is split across (including the caller)
+ * @warning fn is called concurrently and must be thread-safe; it may modify
+ *          values but must not insert or remove entries.
+ */
+void misc_htable_foreach_parallel(const misc_htable ht, misc_htable_visit_fn fn, void *ctx, size_t nthreads);
+
+/**
+ * @brief Collects statistics about the hash table.
+ * @param ht Hash table to inspect
+ * @param out Filled with the statistics
+ * @return 1 on success, 0 if ht or out is NULL
+ * @note Walks every slot, so this costs O(capacity). While an incremental
+ *       rehash is in progress, the entries of both stores are included.
+ * @note The per-operation counters are only maintained when the library is
+ *       built with MISC_STATS defined (make MISC_STATS=1) and are 0 otherwise.
+ *       Time spent in incremental migration steps is also only measured then;
+ *       full rebuilds are always timed.
+ */
+int misc_htable_stats(const misc_htable ht, misc_htable_stats_info *out);
+
+/**
+ * @brief Writes the hash table to a file as a read-only frozen table.
+ * @param ht Hash table to freeze
+ * @param path Path of the file to create or overwrite
+ * @return 1 on success, 0 on allocation or I/O failure, or if the table is
+ *         keyed by pointers
+ * @note An existing file is replaced atomically: the table is written to a
+ *       temporary file in the same directory, synced, then renamed over path.
+ *       Processes that opened the previous file keep reading it unchanged,
+ *       and the file is created with mode 0644.
+ * @note The file is opened with misc_fhtable_open (see misc/fhtable.h). Keys
+ *       are rehashed with fixed functions that do not depend on the table's
+ *       seed or finalizer; string keys are stored in the file.
+ * @note Tables with custom keys are hashed with their hash function, so the
+ *       same function must be passed to misc_fhtable_open.
+ * @warning Keys and values are copied byte for byte: pointers inside them are
+ *          meaningless once the file is loaded elsewhere.
+ */
+int misc_htable_freeze(const misc_htable ht, const char *path);
+
 #endif /* HTABLE_H */
\ No newline at end of file
@@ -0,0 +1,348 @@
+#pragma once
+#ifndef LRU_H
+#define LRU_H
+
+#include <stddef.h>
+#include "misc/htable.h"
+
+
+/**
+ * @brief Opaque handle to a bounded cache instance.
+ *
+ * Entries live in a pool of nodes allocated once at creation and linked by
+ * index in recency order; a misc_htable maps each key to its node. get, put
+ * and eviction are O(1), and a value stays at the same address until its
+ * entry leaves the cache.
+ */
+typedef struct misc_generic_lru* misc_lru;
+
+/**
+ * @brief Opaque handle to a sharded, thread-safe bounded cache instance.
+ *
+ * The key space is split across independent misc_lru shards, each behind its
+ * own mutex. Each shard gets an equal part of the budget, so recency is only
+ * tracked within a shard.
+ */
+typedef struct misc_concurrent_lru* misc_clru;
+
+/**
+ * @brief Flag for creating a cache with the default, exact LRU policy: every
+ *        hit moves the entry to the front.
+ */
+#define MISC_LRU_DEFAULT 0
+
+/**
+ * @brief Flag for creating a cache with the CLOCK (second chance) policy: a
+ *        hit only marks the entry, and eviction skips marked entries once.
+ *        Approximates LRU without relinking on every hit.
+ */
+#define MISC_LRU_CLOCK   (1 << 8)
+
+/**
+ * @brief Function called for each entry the cache drops.
+ * @param key Pointer to the key of the entry
+ * @param value Pointer to the value of the entry
+ * @param ctx User context given to misc_lru_set_evict
+ */
+typedef void (*misc_lru_evict_fn)(const void *key, void *value, void *ctx);
+
+/**
+ * @brief Creates a new cache with custom hash and key comparison functions.
+ * @param value_size Size in bytes of each value
+ * @param key_size Size in bytes of each key
+ * @param hash_func Hash function to use for keys
+ * @param key_cmp Key comparison function
+ * @param capacity Maximum number of entries
+ * @param flags MISC_LRU_DEFAULT or MISC_LRU_CLOCK, optionally OR'd with the
+ *              hash table flags of misc_htable_create
+ * @return Pointer to the new cache, or NULL on allocation failure or invalid arguments
+ * @note All capacity nodes are allocated upfront.
+ */
+misc_lru misc_lru_create(size_t value_size, size_t key_size,
+                         misc_hash_fn hash_func,
+                         misc_key_cmp_fn key_cmp,
+                         size_t capacity,
+                         int flags);
+
+/**
+ * @brief Creates a new cache with string keys.
+ * @param value_size Size in bytes of each value
+ * @param capacity Maximum number of entries
+ * @param flags Cache flags (see misc_lru_create)
+ * @return Pointer to the new cache, or NULL on allocation failure or invalid arguments
+ * @note Keys are passed as a pointer to a char*; the cache keeps its own copy
+ *       of each string.
+ */
+misc_lru misc_lru_create_str(size_t value_size, size_t capacity, int flags);
+
+/**
+ * @brief Creates a new cache with integer keys.
+ * @param value_size Size in bytes of each value
+ * @param capacity Maximum number of entries
+ * @param flags Cache flags (see misc_lru_create)
+ * @return Pointer to the new cache, or NULL on allocation failure or invalid arguments
+ */
+misc_lru misc_lru_create_int(size_t value_size, size_t capacity, int flags);
+
+/**
+ * @brief Creates a new cache with uint64_t keys.
+ * @param value_size Size in bytes of each value
+ * @param capacity Maximum number of entries
+ * @param flags Cache flags (see misc_lru_create)
+ * @return Pointer to the new cache, or NULL on allocation failure or invalid arguments
+ */
+misc_lru misc_lru_create_u64(size_t value_size, size_t capacity, int flags);
+
+/**
+ * @brief Destroys the cache and frees all associated memory.
+ * @param lru Cache to destroy
+ * @note The eviction function is called for every entry still cached.
+ */
+void misc_lru_destroy(misc_lru lru);
+
+/**
+ * @brief Removes all entries from the cache.
+ * @param lru Cache to clear
+ * @note The eviction function is called for every entry. The counters are kept.
+ */
+void misc_lru_clear(misc_lru lru);
+
+/**
+ * @brief Sets the function called for each entry the cache drops.
+ * @param lru Cache to modify
+ * @param fn Function called for entries evicted to respect the budget and for
+ *           entries dropped by clear and destroy, or NULL to disable
+ * @param ctx User context passed to fn
+ * @note Entries removed with misc_lru_remove are handed back through its out
+ *       parameter instead.
+ */
+void misc_lru_set_evict(misc_lru lru, misc_lru_evict_fn fn, void *ctx);
+
+/**
+ * @brief Sets a byte budget on top of the entry capacity.
+ * @param lru Cache to modify
+ * @param max_bytes Maximum sum of the charges of the cached entries, or 0 for no byte budget
+ * @note Entries are evicted right away if the cache is over the new budget.
+ * @note An entry is charged value_size bytes, unless put with misc_lru_put_charged.
+ */
+void misc_lru_set_max_bytes(misc_lru lru, size_t max_bytes);
+
+/**
+ * @brief Returns the number of entries in the cache.
+ * @param lru Cache to query
+ * @return Number of entries, or 0 if lru is NULL
+ */
+size_t misc_lru_size(const misc_lru lru);
+
+/**
+ * @brief Returns the sum of the charges of the cached entries.
+ * @param lru Cache to query
+ * @return Bytes charged, or 0 if lru is NULL
+ */
+size_t misc_lru_bytes(const misc_lru lru);
+
+/**
+ * @brief Looks up a key and marks the entry as recently used.
+ * @param lru Cache to search
+ * @param key Pointer to the key
+ * @return Pointer to the value, or NULL on a miss
+ * @note Counts a hit or a miss.
+ * @warning The pointer remains valid until the entry is evicted or removed.
+ */
+void* misc_lru_get(misc_lru lru, const void *key);
+
+/**
+ * @brief Checks if a key is cached, without marking it as used or counting a hit or miss.
+ * @param lru Cache to search
+ * @param key Pointer to the key
+ * @return 1 if the key is cached, 0 otherwise
+ */
+int misc_lru_contains(const misc_lru lru, const void *key);
+
+/**
+ * @brief Inserts or updates an entry, evicting the least recently used ones if needed.
+ * @param lru Cache to modify
+ * @param key Pointer to the key
+ * @param value Pointer to the value
+ * @return 1 on success, 0 on allocation failure
+ */
+int misc_lru_put(misc_lru lru, const void *key, const void *value);
+
+/**
+ * @brief Inserts or updates an entry with an explicit charge against the byte budget.
+ * @param lru Cache to modify
+ * @param key Pointer to the key
+ * @param value Pointer to the value
+ * @param charge Bytes the entry counts for (e.g. the size of a buffer the value points to)
+ * @return 1 on success, 0 on allocation failure or if charge alone exceeds the byte budget
+ */
+int misc_lru_put_charged(misc_lru lru, const void *key, const void *value, size_t charge);
+
+/**
+ * @brief Removes an entry from the cache.
+ * @param lru Cache to modify
+ * @param key Pointer to the key
+ * @param out Optional buffer the removed value is copied to (can be NULL)
+ * @return 1 if the key was found and removed, 0 otherwise
+ * @note The eviction function is not called.
+ */
+int misc_lru_remove(misc_lru lru, const void *key, void *out);
+
+/**
+ * @brief Returns the number of gets that found their key.
+ * @param lru Cache to query
+ * @return Number of hits, or 0 if lru is NULL
+ */
+size_t misc_lru_hits(const misc_lru lru);
+
+/**
+ * @brief Returns the number of gets that did not find their key.
+ * @param lru Cache to query
+ * @return Number of misses, or 0 if lru is NULL
+ */
+size_t misc_lru_misses(const misc_lru lru);
+
+/**
+ * @brief Returns the number of entries evicted to respect the budget.
+ * @param lru Cache to query
+ * @return Number of evictions, or 0 if lru is NULL
+ */
+size_t misc_lru_evictions(const misc_lru lru);
+
+/**
+ * @brief Creates a new sharded cache with custom hash and key comparison functions.
+ * @param value_size Size in bytes of each value
+ * @param key_size Size in bytes of each key
+ * @param hash_func Hash function to use for keys
+ * @param key_cmp Key comparison function
+ * @param capacity Maximum number of entries, split evenly across the shards
+ * @param nshards Number of shards, rounded up to a power of two
+ * @param flags Cache flags (see misc_lru_create); MISC_HTABLE_INCREMENTAL is not supported
+ * @return Pointer to the new cache, or NULL on allocation failure or invalid arguments
+ */
+misc_clru misc_clru_create(size_t value_size, size_t key_size,
+                           misc_hash_fn hash_func,
+                           misc_key_cmp_fn key_cmp,
+                           size_t capacity,
+                           size_t nshards,
+                           int flags);
+
+/**
+ * @brief Creates a new sharded cache with string keys.
+ * @param value_size Size in bytes of each value
+ * @param capacity Maximum number of entries, split evenly across the shards
+ * @param nshards Number of shards, rounded up to a power of two
+ * @param flags Cache flags (see misc_clru_create)
+ * @return Pointer to the new cache, or NULL on allocation failure or invalid arguments
+ */
+misc_clru misc_clru_create_str(size_t value_size, size_t capacity, size_t nshards, int flags);
+
+/**
+ * @brief Creates a new sharded cache with integer keys.
+ * @param value_size Size in bytes of each value
+ * @param capacity Maximum number of entries, split evenly across the shards
+ * @param nshards Number of shards, rounded up to a power of two
+ * @param flags Cache flags (see misc_clru_create)
+ * @return Pointer to the new cache, or NULL on allocation failure or invalid arguments
+ */
+misc_clru misc_clru_create_int(size_t value_size, size_t capacity, size_t nshards, int flags);
+
+/**
+ * @brief Creates a new sharded cache with uint64_t keys.
+ * @param value_size Size in bytes of each value
+ * @param capacity Maximum number of entries, split evenly across the shards
+ * @param nshards Number of shards, rounded up to a power of two
+ * @param flags Cache flags (see misc_clru_create)
+ * @return Pointer to the new cache, or NULL on allocation failure or invalid arguments
+ */
+misc_clru misc_clru_create_u64(size_t value_size, size_t capacity, size_t nshards, int flags);
+
+/**
+ * @brief Destroys the sharded cache and frees all associated memory.
+ * @param clru Cache to destroy
+ * @warning No other thread may use the cache during or after this call.
+ */
+void misc_clru_destroy(misc_clru clru);
+
+/**
+ * @brief Sets the function called for each entry the cache drops (see misc_lru_set_evict).
+ * @param clru Cache to modify
+ * @param fn Eviction function, or NULL to disable
+ * @param ctx User context passed to fn
+ * @note fn runs with the entry's shard locked and must not use the cache.
+ */
+void misc_clru_set_evict(misc_clru clru, misc_lru_evict_fn fn, void *ctx);
+
+/**
+ * @brief Sets a byte budget, split evenly across the shards (see misc_lru_set_max_bytes).
+ * @param clru Cache to modify
+ * @param max_bytes Maximum sum of the charges of the cached entries, or 0 for no byte budget
+ */
+void misc_clru_set_max_bytes(misc_clru clru, size_t max_bytes);
+
+/**
+ * @brief Returns the number of entries in the sharded cache.
+ * @param clru Cache to query
+ * @return Number of entries; only a snapshot while other threads modify the cache
+ */
+size_t misc_clru_size(const misc_clru clru);
+
+/**
+ * @brief Looks up a key, marks the entry as recently used and copies its value out.
+ * @param clru Cache to search
+ * @param key Pointer to the key
+ * @param out Buffer the value is copied to (can be NULL)
+ * @return 1 on a hit, 0 on a miss
+ */
+int misc_clru_get(misc_clru clru, const void *key, void *out);
+
+/**
+ * @brief Inserts or updates an entry (see misc_lru_put).
+ * @param clru Cache to modify
+ * @param key Pointer to the key
+ * @param value Pointer to the value
+ * @return 1 on success, 0 on allocation failure
+ */
+int misc_clru_put(misc_clru clru, const void *key, const void *value);
+
+/**
+ * @brief Inserts or updates an entry with an explicit charge (see misc_lru_put_charged).
+ * @param clru Cache to modify
+ * @param key Pointer to the key
+ * @param value Pointer to the value
+ * @param charge Bytes the entry counts for
+ * @return 1 on success, 0 on allocation failure or if charge alone exceeds the shard's byte budget
+ */
+int misc_clru_put_charged(misc_clru clru, const void *key, const void *value, size_t charge);
+
+/**
+ * @brief Removes an entry from the sharded cache (see misc_lru_remove).
+ * @param clru Cache to modify
+ * @param key Pointer to the key
+ * @param out Optional buffer the removed value is copied to (can be NULL)
+ * @return 1 if the key was found and removed, 0 otherwise
+ */
+int misc_clru_remove(misc_clru clru, const void *key, void *out);
+
+/**
+ * @brief Returns the number of gets that found their key, over all shards.
+ * @param clru Cache to query
+ * @return Number of hits
+ */
+size_t misc_clru_hits(const misc_clru clru);
+
+/**
+ * @brief Returns the number of gets that did not find their key, over all shards.
+ * @param clru Cache to query
+ * @return Number of misses
+ */
+size_t misc_clru_misses(const misc_clru clru);
+
+/**
+ * @brief Returns the number of entries evicted to respect the budget, over all shards.
+ * @param clru Cache to query
+ * @return Number of evictions
+ */
+size_t misc_clru_evictions(const misc_clru clru);
+
+#endif
@@ -0,0 +1,148 @@
+#pragma once
+#ifndef SMALLVEC_H
+#define SMALLVEC_H
+
+#include <stddef.h>
+
+
+/**
+ * @brief Opaque handle to a small vector instance.
+ *
+ * The first elements are stored inline, in the same allocation as the
+ * vector itself, so a small vector that never outgrows its inline capacity
+ * costs a single malloc. Once it overflows, the elements move to a heap
+ * buffer that grows like misc_vector's.
+ */
+typedef struct misc_generic_smallvec* misc_smallvec;
+
+/**
+ * @brief Creates a new small vector.
+ * @param elem_size Size in bytes of each element
+ * @param inline_capacity Number of elements stored inline (a compile-time
+ *                        constant at most call sites)
+ * @return Pointer to the new vector, or NULL on allocation failure or invalid arguments
+ */
+misc_smallvec misc_smallvec_create(size_t elem_size, size_t inline_capacity);
+
+/**
+ * @brief Destroys the vector and frees all associated memory.
+ * @param vec Vector to destroy
+ */
+void misc_smallvec_destroy(misc_smallvec vec);
+
+/**
+ * @brief Removes all elements from the vector.
+ * @param vec Vector to clear
+ * @note The capacity remains unchanged; see misc_smallvec_shrink_to_fit.
+ */
+void misc_smallvec_clear(misc_smallvec vec);
+
+/**
+ * @brief Returns the number of elements currently stored in the vector.
+ * @param vec Vector to query
+ * @return Number of elements, or 0 if vec is NULL
+ */
+size_t misc_smallvec_length(const misc_smallvec vec);
+
+/**
+ * @brief Returns the current capacity of the vector.
+ * @param vec Vector to query
+ * @return Number of elements that can be stored without reallocation, or 0 if vec is NULL
+ */
+size_t misc_smallvec_capacity(const misc_smallvec vec);
+
+/**
+ * @brief Checks if the vector is empty.
+ * @param vec Vector to check
+ * @return 1 if the vector contains no elements, 0 otherwise
+ */
+int misc_smallvec_isempty(const misc_smallvec vec);
+
+/**
+ * @brief Checks if the elements are still stored inline.
+ * @param vec Vector to check
+ * @return 1 if the elements are inline, 0 if they have moved to the heap
+ */
+int misc_smallvec_isinline(const misc_smallvec vec);
+
+/**
+ * @brief Appends an element to the end of the vector.
+ * @param vec Vector to modify
+ * @param elem Pointer to the element to append
+ * @return 1 on success, 0 on allocation failure
+ * @note Overflowing the inline capacity moves the elements to the heap.
+ */
+int misc_smallvec_pushback(misc_smallvec vec, const void *elem);
+
+/**
+ * @brief Removes and optionally retrieves the last element from the vector.
+ * @param vec Vector to modify
+ * @param out Optional pointer where removed element will be copied (can be NULL)
+ * @note Does nothing if the vector is empty.
+ */
+void misc_smallvec_popback(misc_smallvec vec, void *out);
+
+/**
+ * @brief Inserts an element at the specified index.
+ * @param vec Vector to modify
+ * @param idx Index where to insert the element
+ * @param elem Pointer to the element to insert
+ * @return 1 on success, 0 on allocation failure or invalid index
+ * @note Elements at and after the index are shifted right.
+ */
+int misc_smallvec_insert(misc_smallvec vec, size_t idx, const void *elem);
+
+/**
+ * @brief Removes the element at the specified index.
+ * @param vec Vector to modify
+ * @param idx Index of element to remove
+ * @param out Optional pointer where removed element will be copied (can be NULL)
+ * @return 1 on success, 0 if the index is out of bounds
+ * @note Elements after the index are shifted left.
+ */
+int misc_smallvec_remove(misc_smallvec vec, size_t idx, void *out);
+
+/**
+ * @brief Sets the value of the element at the specified index.
+ * @param vec Vector to modify
+ * @param idx Index of element to set
+ * @param elem Pointer to the new element value
+ * @note Does nothing if the index is out of bounds.
+ */
+void misc_smallvec_set(misc_smallvec vec, size_t idx, const void *elem);
+
+/**
+ * @brief Returns a pointer to the element at the specified index.
+ * @param vec Vector to query
+ * @param idx Index of element to retrieve
+ * @return Pointer to the element, or NULL if index is out of bounds
+ * @warning The pointer remains valid until the vector is modified.
+ */
+void* misc_smallvec_get(const misc_smallvec vec, size_t idx);
+
+/**
+ * @brief Returns a pointer to the first element in the vector.
+ * @param vec Vector to query
+ * @return Pointer to the first element, or NULL if vector is empty
+ * @warning The pointer remains valid until the vector is modified.
+ */
+void* misc_smallvec_front(const misc_smallvec vec);
+
+/**
+ * @brief Returns a pointer to the last element in the vector.
+ * @param vec Vector to query
+ * @return Pointer to the last element, or NULL if vector is empty
+ * @warning The pointer remains valid until the vector is modified.
+ */
+void* misc_smallvec_back(const misc_smallvec vec);
+
+/**
+ * @brief Releases the heap capacity beyond the current length.
+ * @param vec Vector to modify
+ * @return 1 on success, 0 on allocation failure (the vector is left unchanged)
+ * @note The elements move back inline, and the heap buffer is freed, if they fit.
+ * @warning Pointers to elements are invalidated.
+ */
+int misc_smallvec_shrink_to_fit(misc_smallvec vec);
+
+#endif /* SMALLVEC_H */
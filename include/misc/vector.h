@@ -6,6 +6,12 @@
 
 #define DEFAULT_CAPACITY 32
 
+/*
+ * Factor the capacity is multiplied by when a vector runs out of room,
+ * unless changed with misc_vector_set_growth_factor.
+ */
+#define MISC_VECTOR_GROWTH_FACTOR 2.0
+
 /*
  * Opaque handle to a vector instance.
  */
@@ -18,6 +24,24 @@ typedef struct misc_generic_vector* misc_vector;
  */
 misc_vector misc_vector_create(size_t elem_size);
 
+/**
+ * @brief Creates a new vector with room for a given number of elements.
+ * @param elem_size Size in bytes of each element
+ * @param capacity Initial capacity; 0 defers all allocation to the first insertion
+ * @return Pointer to the new vector, or NULL on allocation failure
+ * @note misc_vector_create is equivalent to a capacity of DEFAULT_CAPACITY.
+ */
+misc_vector misc_vector_create_with_capacity(size_t elem_size, size_t capacity);
+
+/**
+ * @brief Sets the factor the capacity grows by when the vector is full.
+ * @param vec Vector to modify
+ * @param factor Growth factor, greater than 1 (MISC_VECTOR_GROWTH_FACTOR by default)
+ * @return 1 on success, 0 if the factor is invalid
+ * @note Smaller factors waste less memory, larger ones reallocate less often.
+ */
+int misc_vector_set_growth_factor(misc_vector vec, double factor);
+
 /**
  * @brief Destroys the vector and frees all associated memory.
  * @param vec Vector to destroy
@@ -46,6 +70,33 @@ size_t misc_vector_length(const misc_vector vec);
  */
 size_t misc_vector_capacity(const misc_vector vec);
 
+/**
+ * @brief Ensures the vector can hold a number of elements without reallocating.
+ * @param vec Vector to modify
+ * @param capacity Minimum capacity
+ * @return 1 on success, 0 on allocation failure
+ * @note Allocates exactly the requested capacity; does nothing if it is already available.
+ */
+int misc_vector_reserve(misc_vector vec, size_t capacity);
+
+/**
+ * @brief Changes the number of elements in the vector.
+ * @param vec Vector to modify
+ * @param length New length
+ * @param fill Optional pointer to the value of new elements (NULL zero-fills them)
+ * @return 1 on success, 0 on allocation failure
+ * @note Shrinking only drops elements from the end and keeps the capacity.
+ */
+int misc_vector_resize(misc_vector vec, size_t length, const void *fill);
+
+/**
+ * @brief Releases the capacity beyond the current length.
+ * @param vec Vector to modify
+ * @return 1 on success, 0 on allocation failure (the vector is left unchanged)
+ * @warning Pointers to elements are invalidated.
+ */
+int misc_vector_shrink_to_fit(misc_vector vec);
+
 /**
  * @brief Checks if the vector is empty.
  * @param vec Vector to check
@@ -58,10 +109,29 @@ int misc_vector_isempty(const misc_vector vec);
  * @param vec Vector to modify
  * @param elem Pointer to the element to append
  * @return 1 on success, 0 on allocation failure
- * @note Automatically grows the vector if necessary.
+ * @note Automatically grows the vector by its growth factor if necessary.
  */
 int misc_vector_pushback(misc_vector vec, const void *elem);
 
+/**
+ * @brief Appends an array of elements to the end of the vector.
+ * @param vec Vector to modify
+ * @param elems Pointer to the first of n contiguous elements
+ * @param n Number of elements to append
+ * @return 1 on success, 0 on allocation failure
+ * @note Grows the vector at most once and copies the elements with a single memcpy.
+ * @warning elems must not point into the vector itself.
+ */
+int misc_vector_pushback_n(misc_vector vec, const void *elems, size_t n);
+
+/**
+ * @brief Appends all the elements of a vector to another.
+ * @param dst Vector to modify
+ * @param src Vector whose elements are appended (can be dst itself)
+ * @return 1 on success, 0 on allocation failure or if the element sizes differ
+ */
+int misc_vector_append_vector(misc_vector dst, const misc_vector src);
+
 /**
  * @brief Removes and optionally retrieves the last element from the vector.
  * @param vec Vector to modify
@@ -80,6 +150,19 @@ void misc_vector_popback(misc_vector vec, void *out);
  */
 int misc_vector_insert(misc_vector vec, size_t idx, const void *elem);
 
+/**
+ * @brief Inserts an array of elements at the specified index.
+ * @param vec Vector to modify
+ * @param idx Index where to insert the first element
+ * @param elems Pointer to the first of n contiguous elements
+ * @param n Number of elements to insert
+ * @return 1 on success, 0 on allocation failure or invalid index
+ * @note Elements at and after the index are shifted right once, so inserting
+ *       n elements costs O(length + n).
+ * @warning elems must not point into the vector itself.
+ */
+int misc_vector_insert_n(misc_vector vec, size_t idx, const void *elems, size_t n);
+
 /**
  * @brief Removes the element at the specified index.
  * @param vec Vector to modify
@@ -90,6 +173,17 @@ int misc_vector_insert(misc_vector vec, size_t idx, const void *elem);
  */
 int misc_vector_remove(misc_vector vec, size_t idx, void *out);
 
+/**
+ * @brief Removes a range of consecutive elements.
+ * @param vec Vector to modify
+ * @param idx Index of the first element to remove
+ * @param n Number of elements to remove
+ * @param out Optional buffer of n elements where the removed elements will be copied (can be NULL)
+ * @return 1 on success, 0 if the range is out of bounds
+ * @note Elements after the range are shifted left once.
+ */
+int misc_vector_remove_range(misc_vector vec, size_t idx, size_t n, void *out);
+
 /**
  * @brief Sets the value of the element at the specified index.
  * @param vec Vector to modify
@@ -0,0 +1,213 @@
+#pragma once
+#ifndef VECTOR_TYPED_H
+#define VECTOR_TYPED_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "misc/vector.h"
+
+/*
+ * Header-only, type-specialised vectors.
+ *
+ * MISC_VECTOR_DEFINE(T) generates a misc_vector_T handle type and static
+ * inline misc_vector_T_* functions mirroring the misc_vector API. Elements
+ * are stored as a T array and moved by assignment, so the compiler sees
+ * through every accessor and can vectorize loops over them; misc_vector
+ * remains the type-erased variant.
+ *
+ * T must be a single identifier; use MISC_VECTOR_DEFINE_NAMED for other
+ * types, e.g. MISC_VECTOR_DEFINE_NAMED(char*, str) defines misc_vector_str.
+ * Define each vector once per translation unit.
+ */
+
+/**
+ * @brief Defines a vector of T named misc_vector_T.
+ * @param T Element type, a single identifier (e.g. int, double, a typedef name)
+ */
+#define MISC_VECTOR_DEFINE(T) MISC_VECTOR_DEFINE_NAMED(T, T)
+
+/**
+ * @brief Defines a vector of T named misc_vector_name.
+ * @param T Element type
+ * @param name Suffix of the generated type and function names
+ *
+ * Generated functions, with V standing for misc_vector_name:
+ *
+ *   V      V_create(void)                  NULL on allocation failure
+ *   V      V_create_with_capacity(size_t)
+ *   void   V_destroy(V)
+ *   void   V_clear(V)
+ *   size_t V_length(const V)
+ *   size_t V_capacity(const V)
+ *   int    V_isempty(const V)
+ *   int    V_reserve(V, size_t)            1 on success, 0 on allocation failure
+ *   int    V_pushback(V, T)                1 on success, 0 on allocation failure
+ *   int    V_pushback_n(V, T const*, size_t)
+ *   int    V_popback(V, T *out)            0 if the vector is empty
+ *   int    V_insert(V, size_t idx, T)      0 on allocation failure or invalid index
+ *   int    V_remove(V, size_t idx, T *out) 0 if the index is out of bounds
+ *   T      V_get(const V, size_t idx)      unchecked, like indexing an array
+ *   void   V_set(V, size_t idx, T)         unchecked, like indexing an array
+ *   T*     V_at(const V, size_t idx)       NULL if the index is out of bounds
+ *   T*     V_data(const V)                 the elements as a plain array
+ *
+ * out parameters can be NULL. Pointers into the vector remain valid until
+ * it is modified.
+ */
+#define MISC_VECTOR_DEFINE_NAMED(T, name)                                                       \
+                                                                                                \
+typedef struct misc_typed_vector_##name                                                         \
+{                                                                                               \
+    T *data;                                                                                    \
+    size_t length;                                                                              \
+    size_t capacity;                                                                            \
+} *misc_vector_##name;                                                                          \
+                                                                                                \
+static inline misc_vector_##name misc_vector_##name##_create_with_capacity(size_t capacity)     \
+{                                                                                               \
+    if (capacity > SIZE_MAX / sizeof(T)) return NULL;                                           \
+                                                                                                \
+    misc_vector_##name vec = (misc_vector_##name)malloc(sizeof(struct misc_typed_vector_##name)); \
+    if (vec == NULL) return NULL;                                                               \
+                                                                                                \
+    vec->data = NULL;                                                                           \
+    if (capacity > 0)                                                                           \
+    {                                                                                           \
+        vec->data = (T*)malloc(capacity * sizeof(T));                                           \
+        if (vec->data == NULL)                                                                  \
+        {                                                                                       \
+            free(vec);                                                                          \
+            return NULL;                                                                        \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    vec->length = 0;                                                                            \
+    vec->capacity = capacity;                                                                   \
+    return vec;                                                                                 \
+}                                                                                               \
+                                                                                                \
+static inline misc_vector_##name misc_vector_##name##_create(void)                              \
+{                                                                                               \
+    return misc_vector_##name##_create_with_capacity(DEFAULT_CAPACITY);                         \
+}                                                                                               \
+                                                                                                \
+static inline void misc_vector_##name##_destroy(misc_vector_##name vec)                         \
+{                                                                                               \
+    if (vec == NULL) return;                                                                    \
+                                                                                                \
+    free(vec->data);                                                                            \
+    free(vec);                                                                                  \
+}                                                                                               \
+                                                                                                \
+static inline void misc_vector_##name##_clear(misc_vector_##name vec)                           \
+{                                                                                               \
+    vec->length = 0;                                                                            \
+}                                                                                               \
+                                                                                                \
+static inline size_t misc_vector_##name##_length(const misc_vector_##name vec)                  \
+{                                                                                               \
+    return vec->length;                                                                         \
+}                                                                                               \
+                                                                                                \
+static inline size_t misc_vector_##name##_capacity(const misc_vector_##name vec)                \
+{                                                                                               \
+    return vec->capacity;                                                                       \
+}                                                                                               \
+                                                                                                \
+static inline int misc_vector_##name##_isempty(const misc_vector_##name vec)                    \
+{                                                                                               \
+    return vec->length == 0;                                                                    \
+}                                                                                               \
+                                                                                                \
+static inline int misc_vector_##name##_reserve(misc_vector_##name vec, size_t capacity)         \
+{                                                                                               \
+    if (capacity <= vec->capacity) return 1;                                                    \
+    if (capacity > SIZE_MAX / sizeof(T)) return 0;                                              \
+                                                                                                \
+    T *data = (T*)realloc(vec->data, capacity * sizeof(T));                                     \
+    if (data == NULL) return 0;                                                                 \
+                                                                                                \
+    vec->data = data;                                                                           \
+    vec->capacity = capacity;                                                                   \
+    return 1;                                                                                   \
+}                                                                                               \
+                                                                                                \
+/* Grows by MISC_VECTOR_GROWTH_FACTOR, or to min_cap if that is larger */                       \
+static inline int misc_vector_##name##_grow_(misc_vector_##name vec, size_t min_cap)            \
+{                                                                                               \
+    double grown = (double)vec->capacity * MISC_VECTOR_GROWTH_FACTOR;                           \
+    size_t capacity = grown < (double)(SIZE_MAX / sizeof(T)) ? (size_t)grown : SIZE_MAX / sizeof(T); \
+    return misc_vector_##name##_reserve(vec, capacity > min_cap ? capacity : min_cap);          \
+}                                                                                               \
+                                                                                                \
+static inline int misc_vector_##name##_pushback(misc_vector_##name vec, T elem)                 \
+{                                                                                               \
+    if (vec->length == vec->capacity && !misc_vector_##name##_grow_(vec, vec->length + 1)) return 0; \
+                                                                                                \
+    vec->data[vec->length++] = elem;                                                            \
+    return 1;                                                                                   \
+}                                                                                               \
+                                                                                                \
+static inline int misc_vector_##name##_pushback_n(misc_vector_##name vec, T const *elems, size_t n) \
+{                                                                                               \
+    if (n > SIZE_MAX - vec->length) return 0;                                                   \
+    if (vec->length + n > vec->capacity && !misc_vector_##name##_grow_(vec, vec->length + n)) return 0; \
+                                                                                                \
+    for (size_t i = 0; i < n; i++) vec->data[vec->length + i] = elems[i];                       \
+    vec->length += n;                                                                           \
+    return 1;                                                                                   \
+}                                                                                               \
+                                                                                                \
+static inline int misc_vector_##name##_popback(misc_vector_##name vec, T *out)                  \
+{                                                                                               \
+    if (vec->length == 0) return 0;                                                             \
+                                                                                                \
+    vec->length--;                                                                              \
+    if (out != NULL) *out = vec->data[vec->length];                                             \
+    return 1;                                                                                   \
+}                                                                                               \
+                                                                                                \
+static inline int misc_vector_##name##_insert(misc_vector_##name vec, size_t idx, T elem)       \
+{                                                                                               \
+    if (idx > vec->length) return 0;                                                            \
+    if (vec->length == vec->capacity && !misc_vector_##name##_grow_(vec, vec->length + 1)) return 0; \
+                                                                                                \
+    memmove(vec->data + idx + 1, vec->data + idx, (vec->length - idx) * sizeof(T));             \
+    vec->data[idx] = elem;                                                                      \
+    vec->length++;                                                                              \
+    return 1;                                                                                   \
+}                                                                                               \
+                                                                                                \
+static inline int misc_vector_##name##_remove(misc_vector_##name vec, size_t idx, T *out)       \
+{                                                                                               \
+    if (idx >= vec->length) return 0;                                                           \
+                                                                                                \
+    if (out != NULL) *out = vec->data[idx];                                                     \
+    memmove(vec->data + idx, vec->data + idx + 1, (vec->length - idx - 1) * sizeof(T));         \
+    vec->length--;                                                                              \
+    return 1;                                                                                   \
+}                                                                                               \
+                                                                                                \
+static inline T misc_vector_##name##_get(const misc_vector_##name vec, size_t idx)              \
+{                                                                                               \
+    return vec->data[idx];                                                                      \
+}                                                                                               \
+                                                                                                \
+static inline void misc_vector_##name##_set(misc_vector_##name vec, size_t idx, T elem)         \
+{                                                                                               \
+    vec->data[idx] = elem;                                                                      \
+}                                                                                               \
+                                                                                                \
+static inline T* misc_vector_##name##_at(const misc_vector_##name vec, size_t idx)              \
+{                                                                                               \
+    return idx < vec->length ? vec->data + idx : NULL;                                          \
+}                                                                                               \
+                                                                                                \
+static inline T* misc_vector_##name##_data(const misc_vector_##name vec)                        \
+{                                                                                               \
+    return vec->data;                                                                           \
+}
+
+#endif /* VECTOR_TYPED_H */
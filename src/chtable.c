@@ -0,0 +1,235 @@
+#include "misc/chtable.h"
+#include "misc/htable.h"
+#include "shards.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* The lock comes first, on its own cache line(s): see shards.h */
+typedef struct misc_chtable_shard
+{
+
+    _Alignas(MISC_SHARD_CACHE_LINE) pthread_rwlock_t lock;
+    misc_htable ht;
+
+} misc_chtable_shard;
+
+struct misc_concurrent_hashtable
+{
+
+    misc_chtable_shard *shards;
+    size_t nshards;
+
+    size_t value_size;
+
+};
+
+
+static misc_chtable_shard* _misc_chtable_shard(const misc_chtable ch, const void *key)
+{
+    size_t hash = misc_htable_hash(ch->shards[0].ht, key);
+    return &ch->shards[_misc_shards_index(hash, ch->nshards)];
+}
+
+static int _misc_chtable_lock_init(void *lock)
+{
+    return pthread_rwlock_init((pthread_rwlock_t*)lock, NULL) == 0;
+}
+
+static void _misc_chtable_lock_destroy(void *lock)
+{
+    pthread_rwlock_destroy((pthread_rwlock_t*)lock);
+}
+
+static misc_chtable _misc_chtable_alloc(size_t value_size, size_t nshards, int flags)
+{
+    if (flags & MISC_HTABLE_INCREMENTAL) return NULL;
+
+    misc_chtable ch = (misc_chtable)malloc(sizeof(struct misc_concurrent_hashtable));
+    if (ch == NULL) return NULL;
+
+    ch->value_size = value_size;
+    ch->shards = (misc_chtable_shard*)_misc_shards_alloc(nshards, sizeof(misc_chtable_shard), &ch->nshards);
+    if (ch->shards == NULL)
+    {
+        free(ch);
+        return NULL;
+    }
+
+    return ch;
+}
+
+/*
+ * Called once every shard has been given its hash table: sets up the locks,
+ * or tears everything down if any of the tables or locks could not be set up.
+ */
+static misc_chtable _misc_chtable_init(misc_chtable ch)
+{
+    int ok = 1;
+    for (size_t i = 0; i < ch->nshards; i++)
+    {
+        if (ch->shards[i].ht == NULL) ok = 0;
+    }
+
+    if (ok)
+    {
+        ok = _misc_shards_init_locks(ch->shards, ch->nshards, sizeof(misc_chtable_shard),
+                                     _misc_chtable_lock_init, _misc_chtable_lock_destroy);
+    }
+
+    if (!ok)
+    {
+        for (size_t i = 0; i < ch->nshards; i++)
+        {
+            misc_htable_destroy(ch->shards[i].ht);
+        }
+        free(ch->shards);
+        free(ch);
+        return NULL;
+    }
+
+    return ch;
+}
+
+
+misc_chtable misc_chtable_create(size_t value_size, size_t key_size,
+                                 misc_hash_fn hash_func,
+                                 misc_key_cmp_fn key_cmp,
+                                 size_t nshards,
+                                 int flags)
+{
+    misc_chtable ch = _misc_chtable_alloc(value_size, nshards, flags);
+    if (ch == NULL) return NULL;
+
+    for (size_t i = 0; i < ch->nshards; i++)
+    {
+        ch->shards[i].ht = misc_htable_create(value_size, key_size, hash_func, key_cmp, flags);
+    }
+
+    return _misc_chtable_init(ch);
+}
+
+misc_chtable misc_chtable_create_str(size_t value_size, size_t nshards, int flags)
+{
+    misc_chtable ch = _misc_chtable_alloc(value_size, nshards, flags);
+    if (ch == NULL) return NULL;
+
+    for (size_t i = 0; i < ch->nshards; i++)
+    {
+        ch->shards[i].ht = misc_htable_create_str(value_size, flags);
+    }
+
+    return _misc_chtable_init(ch);
+}
+
+misc_chtable misc_chtable_create_int(size_t value_size, size_t nshards, int flags)
+{
+    misc_chtable ch = _misc_chtable_alloc(value_size, nshards, flags);
+    if (ch == NULL) return NULL;
+
+    for (size_t i = 0; i < ch->nshards; i++)
+    {
+        ch->shards[i].ht = misc_htable_create_int(value_size, flags);
+    }
+
+    return _misc_chtable_init(ch);
+}
+
+void misc_chtable_destroy(misc_chtable ch)
+{
+    if (ch == NULL) return;
+
+    for (size_t i = 0; i < ch->nshards; i++)
+    {
+        pthread_rwlock_destroy(&ch->shards[i].lock);
+        misc_htable_destroy(ch->shards[i].ht);
+    }
+
+    free(ch->shards);
+    free(ch);
+}
+
+void misc_chtable_clear(misc_chtable ch)
+{
+    if (ch == NULL) return;
+
+    for (size_t i = 0; i < ch->nshards; i++)
+    {
+        pthread_rwlock_wrlock(&ch->shards[i].lock);
+        misc_htable_clear(ch->shards[i].ht);
+        pthread_rwlock_unlock(&ch->shards[i].lock);
+    }
+}
+
+size_t misc_chtable_size(const misc_chtable ch)
+{
+    if (ch == NULL) return 0;
+
+    size_t size = 0;
+    for (size_t i = 0; i < ch->nshards; i++)
+    {
+        pthread_rwlock_rdlock(&ch->shards[i].lock);
+        size += misc_htable_size(ch->shards[i].ht);
+        pthread_rwlock_unlock(&ch->shards[i].lock);
+    }
+
+    return size;
+}
+
+int misc_chtable_contains(const misc_chtable ch, const void *key)
+{
+    if (ch == NULL || key == NULL) return 0;
+
+    misc_chtable_shard *shard = _misc_chtable_shard(ch, key);
+
+    pthread_rwlock_rdlock(&shard->lock);
+    int found = misc_htable_contains(shard->ht, key);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return found;
+}
+
+int misc_chtable_get(const misc_chtable ch, const void *key, void *out)
+{
+    if (ch == NULL || key == NULL || out == NULL) return 0;
+
+    misc_chtable_shard *shard = _misc_chtable_shard(ch, key);
+    int found = 0;
+
+    pthread_rwlock_rdlock(&shard->lock);
+    void *value = misc_htable_get(shard->ht, key);
+    if (value != NULL)
+    {
+        memcpy(out, value, ch->value_size);
+        found = 1;
+    }
+    pthread_rwlock_unlock(&shard->lock);
+
+    return found;
+}
+
+int misc_chtable_put(misc_chtable ch, const void *key, const void *value)
+{
+    if (ch == NULL || key == NULL || value == NULL) return 0;
+
+    misc_chtable_shard *shard = _misc_chtable_shard(ch, key);
+
+    pthread_rwlock_wrlock(&shard->lock);
+    int ok = misc_htable_put(shard->ht, key, value);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return ok;
+}
+
+int misc_chtable_remove(misc_chtable ch, const void *key)
+{
+    if (ch == NULL || key == NULL) return 0;
+
+    misc_chtable_shard *shard = _misc_chtable_shard(ch, key);
+
+    pthread_rwlock_wrlock(&shard->lock);
+    int removed = misc_htable_remove(shard->ht, key);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return removed;
+}
@@ -0,0 +1,221 @@
+#include "misc/fhtable.h"
+#include "hashfn.h"
+#include "fhtable_format.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct misc_frozen_hashtable
+{
+
+    const uint8_t *base;
+    size_t map_size;
+
+    const uint8_t *ctrl;
+    const uint8_t *slots;
+    const char *blob;
+    size_t blob_size;
+
+    uint32_t key_kind;
+    size_t capacity;
+    size_t mask;
+    size_t count;
+
+    size_t key_size;
+    size_t slot_size;
+    size_t key_offset;
+    size_t value_offset;
+
+    misc_hash_fn hash_func;
+    misc_key_cmp_fn key_cmp;
+
+};
+
+
+/*
+ * Checks that the header describes a layout that fits in the file, so that
+ * lookups never read outside the mapping.
+ */
+static int _misc_fhtable_valid(const misc_fhtable_header *hdr, size_t file_size)
+{
+    if (memcmp(hdr->magic, FHTABLE_MAGIC, sizeof(hdr->magic)) != 0) return 0;
+    if (hdr->version != FHTABLE_VERSION) return 0;
+    if (hdr->byte_order != FHTABLE_BYTE_ORDER) return 0;
+    if (hdr->key_kind > FHTABLE_KEY_U64) return 0;
+    if (hdr->file_size != file_size) return 0;
+
+    /* Bounding every field by the file size keeps the sums below from overflowing */
+    if (hdr->key_size > file_size || hdr->value_size > file_size) return 0;
+    if (hdr->key_offset > file_size || hdr->value_offset > file_size) return 0;
+    if (hdr->slots_offset > file_size || hdr->blob_size > file_size) return 0;
+
+    if (hdr->capacity == 0 || (hdr->capacity & (hdr->capacity - 1)) != 0) return 0;
+    if (hdr->count >= hdr->capacity) return 0;
+
+    if (hdr->key_offset < sizeof(uint64_t)) return 0;
+    if (hdr->value_offset < hdr->key_offset + hdr->key_size) return 0;
+    if (hdr->slot_size < hdr->value_offset + hdr->value_size) return 0;
+    if (hdr->key_kind == FHTABLE_KEY_STR && hdr->key_size != sizeof(misc_fhtable_strkey)) return 0;
+    /* Lookups compare key_size bytes of the caller's key, so its size must match the kind */
+    if (hdr->key_kind == FHTABLE_KEY_INT && hdr->key_size != sizeof(int)) return 0;
+    if (hdr->key_kind == FHTABLE_KEY_U64 && hdr->key_size != sizeof(uint64_t)) return 0;
+
+    if (hdr->slots_offset < sizeof(*hdr) || hdr->slots_offset % FHTABLE_ALIGN != 0) return 0;
+    if (hdr->slot_size > (file_size - hdr->slots_offset) / hdr->capacity) return 0;
+    if (hdr->ctrl_offset != hdr->slots_offset + hdr->capacity * hdr->slot_size) return 0;
+    if (hdr->blob_offset != hdr->ctrl_offset + hdr->capacity) return 0;
+    if (hdr->blob_offset + hdr->blob_size != file_size) return 0;
+
+    return 1;
+}
+
+misc_fhtable misc_fhtable_open(const char *path, misc_hash_fn hash_func, misc_key_cmp_fn key_cmp)
+{
+    if (path == NULL) return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || (size_t)sb.st_size < sizeof(misc_fhtable_header))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size_t map_size = (size_t)sb.st_size;
+    void *base = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+
+    const misc_fhtable_header *hdr = (const misc_fhtable_header*)base;
+    int needs_funcs = hdr->key_kind == FHTABLE_KEY_BYTES;
+
+    misc_fhtable ft = NULL;
+    if (_misc_fhtable_valid(hdr, map_size) && (!needs_funcs || (hash_func != NULL && key_cmp != NULL)))
+    {
+        ft = (misc_fhtable)malloc(sizeof(struct misc_frozen_hashtable));
+    }
+
+    if (ft == NULL)
+    {
+        munmap(base, map_size);
+        return NULL;
+    }
+
+    ft->base = (const uint8_t*)base;
+    ft->map_size = map_size;
+    ft->ctrl = ft->base + hdr->ctrl_offset;
+    ft->slots = ft->base + hdr->slots_offset;
+    ft->blob = (const char*)ft->base + hdr->blob_offset;
+    ft->blob_size = hdr->blob_size;
+
+    ft->key_kind = hdr->key_kind;
+    ft->capacity = hdr->capacity;
+    ft->mask = hdr->capacity - 1;
+    ft->count = hdr->count;
+
+    ft->key_size = hdr->key_size;
+    ft->slot_size = hdr->slot_size;
+    ft->key_offset = hdr->key_offset;
+    ft->value_offset = hdr->value_offset;
+
+    ft->hash_func = hash_func;
+    ft->key_cmp = key_cmp;
+
+    return ft;
+}
+
+void misc_fhtable_close(misc_fhtable ft)
+{
+    if (ft == NULL) return;
+
+    munmap((void*)ft->base, ft->map_size);
+    free(ft);
+}
+
+size_t misc_fhtable_size(const misc_fhtable ft)
+{
+    if (ft == NULL) return 0;
+
+    return ft->count;
+}
+
+const void* misc_fhtable_get(const misc_fhtable ft, const void *key)
+{
+    if (ft == NULL || key == NULL) return NULL;
+
+    const char *str = NULL;
+    size_t len = 0;
+    uint64_t word = 0;
+    uint64_t hash;
+
+    switch (ft->key_kind)
+    {
+        case FHTABLE_KEY_STR:
+            str = *(const char**)key;
+            len = strlen(str);
+            hash = _misc_wyhash(str, len, 0);
+            break;
+        case FHTABLE_KEY_INT:
+            hash = _misc_splitmix_fn((size_t)(*(const int*)key));
+            break;
+        case FHTABLE_KEY_U64:
+            memcpy(&word, key, sizeof(word));
+            hash = _misc_splitmix_fn((size_t)word);
+            break;
+        default:
+            hash = _misc_splitmix_fn(ft->hash_func(key));
+            break;
+    }
+
+    uint8_t tag = FHTABLE_TAG(hash);
+    size_t idx = hash & ft->mask;
+
+    /*
+     * A valid file always has empty slots, but the probe is bounded anyway so
+     * that a corrupted file cannot make it loop forever.
+     */
+    for (size_t n = 0; n < ft->capacity && ft->ctrl[idx] != FHTABLE_CTRL_EMPTY; n++)
+    {
+        const uint8_t *slot = ft->slots + idx * ft->slot_size;
+        const uint8_t *slot_key = slot + ft->key_offset;
+        uint64_t slot_hash;
+        memcpy(&slot_hash, slot, sizeof(slot_hash));
+
+        if (ft->ctrl[idx] == tag && slot_hash == hash)
+        {
+            int equal;
+            if (ft->key_kind == FHTABLE_KEY_STR)
+            {
+                misc_fhtable_strkey k;
+                memcpy(&k, slot_key, sizeof(k));
+                equal = k.len == len && k.offset <= ft->blob_size && len <= ft->blob_size - k.offset &&
+                        memcmp(ft->blob + k.offset, str, len) == 0;
+            }
+            else if (ft->key_kind == FHTABLE_KEY_BYTES)
+            {
+                equal = ft->key_cmp(slot_key, key) == 0;
+            }
+            else
+            {
+                equal = memcmp(slot_key, key, ft->key_size) == 0;
+            }
+
+            if (equal) return slot + ft->value_offset;
+        }
+
+        idx = (idx + 1) & ft->mask;
+    }
+
+    return NULL;
+}
+
+int misc_fhtable_contains(const misc_fhtable ft, const void *key)
+{
+    return misc_fhtable_get(ft, key) != NULL;
+}
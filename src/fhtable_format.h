@@ -0,0 +1,66 @@
+#pragma once
+#ifndef MISC_FHTABLE_FORMAT_H
+#define MISC_FHTABLE_FORMAT_H
+
+/*
+ * On-disk layout of a frozen hash table, written by misc_htable_freeze and
+ * mapped by misc_fhtable_open:
+ *
+ *   header | slots (capacity * slot_size) | ctrl (capacity bytes) | string blob
+ *
+ * Slots are laid out like the in-memory ones: [hash][key][value]. String keys
+ * are stored as an offset and length into the blob, where each string is
+ * followed by a NUL. The file uses the byte order of the machine that wrote
+ * it; the header records it so a mismatch is rejected on open.
+ */
+
+#include <stdint.h>
+
+#define FHTABLE_MAGIC      "MISCFHT1"
+#define FHTABLE_VERSION    1
+#define FHTABLE_BYTE_ORDER 0x0102030405060708ULL
+#define FHTABLE_ALIGN      64
+
+#define FHTABLE_CTRL_EMPTY 0x80
+#define FHTABLE_TAG(hash)  ((uint8_t)((uint64_t)(hash) >> 57))
+
+/* How keys are hashed and compared, independently of the source table */
+#define FHTABLE_KEY_BYTES 0   /* user hash function (finalized by splitmix) and key_cmp */
+#define FHTABLE_KEY_STR   1   /* wyhash of the string bytes */
+#define FHTABLE_KEY_INT   2   /* splitmix of the int */
+#define FHTABLE_KEY_U64   3   /* splitmix of the uint64_t */
+
+typedef struct misc_fhtable_strkey
+{
+
+    uint64_t offset;
+    uint64_t len;
+
+} misc_fhtable_strkey;
+
+typedef struct misc_fhtable_header
+{
+
+    char magic[8];
+    uint32_t version;
+    uint32_t key_kind;
+    uint64_t byte_order;
+
+    uint64_t capacity;
+    uint64_t count;
+
+    uint64_t key_size;
+    uint64_t value_size;
+    uint64_t slot_size;
+    uint64_t key_offset;
+    uint64_t value_offset;
+
+    uint64_t slots_offset;
+    uint64_t ctrl_offset;
+    uint64_t blob_offset;
+    uint64_t blob_size;
+    uint64_t file_size;
+
+} misc_fhtable_header;
+
+#endif
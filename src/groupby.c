@@ -0,0 +1,284 @@
+#include "misc/groupby.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/*
+ * misc_groupby runs in three parallel phases over nthreads contiguous slices
+ * of the vector, with a join between phases:
+ *
+ *   1. count: each thread hashes the keys of its slice, remembers the
+ *      partition of every record and counts the records per partition;
+ *   2. scatter: each thread writes the indices of its records into the
+ *      partition-major index array, at offsets computed from the counts;
+ *   3. aggregate: thread p folds the records of partition p into its own table.
+ *
+ * Partitions hold disjoint sets of keys, so merging the tables is a plain
+ * copy into the output table.
+ */
+typedef struct misc_groupby_shared
+{
+
+    misc_vector vec;
+    misc_htable out;
+    misc_groupby_key_fn key_fn;
+    misc_groupby_agg_fn agg_fn;
+    void *ctx;
+
+    size_t n;
+    size_t nthreads;
+    uint32_t *parts;
+    size_t *counts;
+    size_t *index;
+
+} misc_groupby_shared;
+
+typedef struct misc_groupby_job
+{
+
+    misc_groupby_shared *gb;
+    size_t id;
+    misc_htable table;
+    int ok;
+
+} misc_groupby_job;
+
+
+static size_t _misc_groupby_slice_start(const misc_groupby_shared *gb, size_t id)
+{
+    return gb->n / gb->nthreads * id + (id < gb->n % gb->nthreads ? id : gb->n % gb->nthreads);
+}
+
+static void* _misc_groupby_count(void *arg)
+{
+    misc_groupby_job *job = (misc_groupby_job*)arg;
+    misc_groupby_shared *gb = job->gb;
+    size_t *counts = gb->counts + job->id * gb->nthreads;
+    size_t end = _misc_groupby_slice_start(gb, job->id + 1);
+
+    for (size_t i = _misc_groupby_slice_start(gb, job->id); i < end; i++)
+    {
+        size_t hash = misc_htable_hash(gb->out, gb->key_fn(misc_vector_get(gb->vec, i)));
+        uint32_t part = (uint32_t)((hash >> (sizeof(size_t) * 4)) % gb->nthreads);
+
+        gb->parts[i] = part;
+        counts[part]++;
+    }
+
+    return NULL;
+}
+
+static void* _misc_groupby_scatter(void *arg)
+{
+    misc_groupby_job *job = (misc_groupby_job*)arg;
+    misc_groupby_shared *gb = job->gb;
+    size_t *offsets = gb->counts + job->id * gb->nthreads;
+    size_t end = _misc_groupby_slice_start(gb, job->id + 1);
+
+    for (size_t i = _misc_groupby_slice_start(gb, job->id); i < end; i++)
+    {
+        gb->index[offsets[gb->parts[i]]++] = i;
+    }
+
+    return NULL;
+}
+
+static int _misc_groupby_fold(misc_htable table, const misc_groupby_shared *gb, const void *record)
+{
+    int inserted;
+    void *acc = misc_htable_get_or_insert(table, gb->key_fn(record), &inserted);
+    if (acc == NULL) return 0;
+
+    gb->agg_fn(acc, record, inserted, gb->ctx);
+    return 1;
+}
+
+static void* _misc_groupby_aggregate(void *arg)
+{
+    misc_groupby_job *job = (misc_groupby_job*)arg;
+    misc_groupby_shared *gb = job->gb;
+
+    /* After the scatter, the offsets of the last thread are the partition ends */
+    const size_t *ends = gb->counts + (gb->nthreads - 1) * gb->nthreads;
+    size_t start = job->id == 0 ? 0 : ends[job->id - 1];
+
+    job->table = misc_htable_create_like(gb->out);
+    job->ok = job->table != NULL;
+
+    for (size_t k = start; job->ok && k < ends[job->id]; k++)
+    {
+        job->ok = _misc_groupby_fold(job->table, gb, misc_vector_get(gb->vec, gb->index[k]));
+    }
+
+    return NULL;
+}
+
+/*
+ * Runs one phase on every job, as misc_htable_foreach_parallel does: the
+ * calling thread takes the last job, and jobs whose thread could not be
+ * started also run here.
+ */
+static void _misc_groupby_run(misc_groupby_job *jobs, pthread_t *threads, int *started,
+                              size_t nthreads, void *(*phase)(void*))
+{
+    for (size_t i = 0; i + 1 < nthreads; i++)
+    {
+        started[i] = pthread_create(&threads[i], NULL, phase, &jobs[i]) == 0;
+    }
+    started[nthreads - 1] = 0;
+
+    for (size_t i = 0; i < nthreads; i++)
+    {
+        if (!started[i]) phase(&jobs[i]);
+    }
+
+    for (size_t i = 0; i + 1 < nthreads; i++)
+    {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+}
+
+/*
+ * Turns the per-thread counts into scatter offsets, partition-major: the
+ * records of partition p from thread t follow those of partition p from
+ * every earlier thread, so each partition lists its records in vector order.
+ */
+static void _misc_groupby_offsets(misc_groupby_shared *gb)
+{
+    size_t offset = 0;
+    for (size_t p = 0; p < gb->nthreads; p++)
+    {
+        for (size_t t = 0; t < gb->nthreads; t++)
+        {
+            size_t count = gb->counts[t * gb->nthreads + p];
+            gb->counts[t * gb->nthreads + p] = offset;
+            offset += count;
+        }
+    }
+}
+
+static int _misc_groupby_merge(misc_htable out, misc_groupby_job *jobs, size_t nthreads)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < nthreads; i++)
+    {
+        total += misc_htable_size(jobs[i].table);
+    }
+
+    if (!misc_htable_reserve(out, total)) return 0;
+
+    for (size_t i = 0; i < nthreads; i++)
+    {
+        misc_htable_iter it;
+        void *key, *value;
+
+        misc_htable_iter_begin(jobs[i].table, &it);
+        while (misc_htable_iter_next(&it, &key, &value))
+        {
+            if (!misc_htable_put(out, key, value)) return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int _misc_groupby_parallel(misc_groupby_shared *gb)
+{
+    size_t nthreads = gb->nthreads;
+
+    misc_groupby_job *jobs = (misc_groupby_job*)calloc(nthreads, sizeof(misc_groupby_job));
+    pthread_t *threads = (pthread_t*)malloc(nthreads * sizeof(pthread_t));
+    int *started = (int*)malloc(nthreads * sizeof(int));
+    gb->parts = (uint32_t*)malloc(gb->n * sizeof(uint32_t));
+    gb->counts = (size_t*)calloc(nthreads * nthreads, sizeof(size_t));
+    gb->index = (size_t*)malloc(gb->n * sizeof(size_t));
+
+    int ok = jobs != NULL && threads != NULL && started != NULL &&
+             gb->parts != NULL && gb->counts != NULL && gb->index != NULL;
+
+    if (ok)
+    {
+        for (size_t i = 0; i < nthreads; i++)
+        {
+            jobs[i].gb = gb;
+            jobs[i].id = i;
+        }
+
+        _misc_groupby_run(jobs, threads, started, nthreads, _misc_groupby_count);
+        _misc_groupby_offsets(gb);
+        _misc_groupby_run(jobs, threads, started, nthreads, _misc_groupby_scatter);
+
+        /* The partition lists are complete: the record partitions are no longer needed */
+        free(gb->parts);
+        gb->parts = NULL;
+
+        _misc_groupby_run(jobs, threads, started, nthreads, _misc_groupby_aggregate);
+
+        for (size_t i = 0; i < nthreads; i++)
+        {
+            ok &= jobs[i].ok;
+        }
+
+        ok = ok && _misc_groupby_merge(gb->out, jobs, nthreads);
+    }
+
+    if (jobs != NULL)
+    {
+        for (size_t i = 0; i < nthreads; i++)
+        {
+            misc_htable_destroy(jobs[i].table);
+        }
+    }
+
+    free(jobs);
+    free(threads);
+    free(started);
+    free(gb->parts);
+    free(gb->counts);
+    free(gb->index);
+
+    return ok;
+}
+
+int misc_groupby(const misc_vector vec, misc_htable out,
+                 misc_groupby_key_fn key_fn,
+                 misc_groupby_agg_fn agg_fn,
+                 void *ctx,
+                 size_t nthreads)
+{
+    if (vec == NULL || out == NULL || key_fn == NULL || agg_fn == NULL) return 0;
+    if (misc_htable_size(out) != 0) return 0;
+
+    misc_groupby_shared gb;
+    gb.vec = vec;
+    gb.out = out;
+    gb.key_fn = key_fn;
+    gb.agg_fn = agg_fn;
+    gb.ctx = ctx;
+    gb.n = misc_vector_length(vec);
+    gb.nthreads = nthreads;
+    gb.parts = NULL;
+    gb.counts = NULL;
+    gb.index = NULL;
+
+    /* Never more threads than records, nor more partitions than fit the partition ids */
+    if (gb.nthreads > gb.n) gb.nthreads = gb.n;
+    if (gb.nthreads > UINT32_MAX) gb.nthreads = UINT32_MAX;
+
+    int ok;
+    if (gb.nthreads <= 1)
+    {
+        ok = 1;
+        for (size_t i = 0; ok && i < gb.n; i++)
+        {
+            ok = _misc_groupby_fold(out, &gb, misc_vector_get(vec, i));
+        }
+    }
+    else
+    {
+        ok = _misc_groupby_parallel(&gb);
+    }
+
+    if (!ok) misc_htable_clear(out);
+    return ok;
+}
@@ -0,0 +1,133 @@
+#pragma once
+#ifndef MISC_HASHFN_H
+#define MISC_HASHFN_H
+
+/*
+ * Hash functions shared by src/htable.c and src/fhtable.c. Internal header:
+ * the public API is under include/misc.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/*
+ * Default finalizer: the splitmix64 mixing steps. Applied on top of the hash
+ * function so that weak hashes (e.g. the identity on integers) still spread
+ * over the low bits used for indexing and the high bits used for the tag.
+ */
+static inline size_t _misc_splitmix_fn(size_t x)
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
+    x =  x ^ (x >> 31);
+
+    return x;
+}
+
+
+/*
+ * wyhash-style string hash: consumes 16 or 48 bytes per round with 64x64->128
+ * bit multiplications, instead of one byte per round like FNV-1a.
+ */
+#define WY_S0 0xa0761d6478bd642fULL
+#define WY_S1 0xe7037ed1a0b428dbULL
+#define WY_S2 0x8ebc6af09c88c6e3ULL
+#define WY_S3 0x589965cc75374cc3ULL
+
+static inline void _misc_wymum(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)(*a) * (*b);
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t _misc_wymix(uint64_t a, uint64_t b)
+{
+    _misc_wymum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t _misc_wyr8(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t _misc_wyr4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t _misc_wyhash(const void *key, size_t len, uint64_t seed)
+{
+    const uint8_t *p = (const uint8_t*)key;
+    uint64_t a, b;
+
+    seed ^= _misc_wymix(seed ^ WY_S0, WY_S1);
+
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            a = (_misc_wyr4(p) << 32) | _misc_wyr4(p + ((len >> 3) << 2));
+            b = (_misc_wyr4(p + len - 4) << 32) | _misc_wyr4(p + len - 4 - ((len >> 3) << 2));
+        }
+        else if (len > 0)
+        {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t i = len;
+        if (i > 48)
+        {
+            uint64_t see1 = seed, see2 = seed;
+            do
+            {
+                seed = _misc_wymix(_misc_wyr8(p) ^ WY_S1, _misc_wyr8(p + 8) ^ seed);
+                see1 = _misc_wymix(_misc_wyr8(p + 16) ^ WY_S2, _misc_wyr8(p + 24) ^ see1);
+                see2 = _misc_wymix(_misc_wyr8(p + 32) ^ WY_S3, _misc_wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16)
+        {
+            seed = _misc_wymix(_misc_wyr8(p) ^ WY_S1, _misc_wyr8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = _misc_wyr8(p + i - 16);
+        b = _misc_wyr8(p + i - 8);
+    }
+
+    a ^= WY_S1;
+    b ^= seed;
+    _misc_wymum(&a, &b);
+
+    return _misc_wymix(a ^ WY_S0 ^ len, b ^ WY_S1);
+}
+
+#endif
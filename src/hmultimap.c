@@ -0,0 +1,232 @@
+#include "misc/hmultimap.h"
+#include "misc/htable.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define HMULTIMAP_MIN_RUN 4
+
+/*
+ * The value stored in the hash table slot of each key: the run of values is
+ * a single array, grown by doubling.
+ */
+typedef struct misc_hmultimap_run
+{
+
+    void *data;
+    size_t count;
+    size_t capacity;
+
+} misc_hmultimap_run;
+
+struct misc_generic_hmultimap
+{
+
+    misc_htable ht;
+    size_t value_size;
+    size_t total;
+
+};
+
+
+static misc_hmultimap _misc_hmultimap_wrap(misc_htable ht, size_t value_size)
+{
+    if (ht == NULL) return NULL;
+
+    misc_hmultimap mm = (misc_hmultimap)malloc(sizeof(struct misc_generic_hmultimap));
+    if (mm == NULL)
+    {
+        misc_htable_destroy(ht);
+        return NULL;
+    }
+
+    mm->ht = ht;
+    mm->value_size = value_size;
+    mm->total = 0;
+
+    return mm;
+}
+
+misc_hmultimap misc_hmultimap_create(size_t value_size, size_t key_size,
+                                     misc_hash_fn hash_func,
+                                     misc_key_cmp_fn key_cmp,
+                                     int flags)
+{
+    if (value_size == 0) return NULL;
+
+    return _misc_hmultimap_wrap(misc_htable_create(sizeof(misc_hmultimap_run), key_size,
+                                                   hash_func, key_cmp, flags), value_size);
+}
+
+misc_hmultimap misc_hmultimap_create_str(size_t value_size, int flags)
+{
+    if (value_size == 0) return NULL;
+
+    return _misc_hmultimap_wrap(misc_htable_create_str_owned(sizeof(misc_hmultimap_run), flags), value_size);
+}
+
+misc_hmultimap misc_hmultimap_create_int(size_t value_size, int flags)
+{
+    if (value_size == 0) return NULL;
+
+    return _misc_hmultimap_wrap(misc_htable_create_int(sizeof(misc_hmultimap_run), flags), value_size);
+}
+
+misc_hmultimap misc_hmultimap_create_u64(size_t value_size, int flags)
+{
+    if (value_size == 0) return NULL;
+
+    return _misc_hmultimap_wrap(misc_htable_create_u64(sizeof(misc_hmultimap_run), flags), value_size);
+}
+
+static void _misc_hmultimap_free_run(const void *key, void *value, void *ctx)
+{
+    (void)key;
+    (void)ctx;
+
+    free(((misc_hmultimap_run*)value)->data);
+}
+
+void misc_hmultimap_destroy(misc_hmultimap mm)
+{
+    if (mm == NULL) return;
+
+    misc_htable_foreach(mm->ht, _misc_hmultimap_free_run, NULL);
+    misc_htable_destroy(mm->ht);
+    free(mm);
+}
+
+void misc_hmultimap_clear(misc_hmultimap mm)
+{
+    if (mm == NULL) return;
+
+    misc_htable_foreach(mm->ht, _misc_hmultimap_free_run, NULL);
+    misc_htable_clear(mm->ht);
+    mm->total = 0;
+}
+
+size_t misc_hmultimap_key_count(const misc_hmultimap mm)
+{
+    if (mm == NULL) return 0;
+
+    return misc_htable_size(mm->ht);
+}
+
+size_t misc_hmultimap_size(const misc_hmultimap mm)
+{
+    if (mm == NULL) return 0;
+
+    return mm->total;
+}
+
+int misc_hmultimap_add(misc_hmultimap mm, const void *key, const void *value)
+{
+    if (mm == NULL || key == NULL || value == NULL) return 0;
+
+    int inserted;
+    misc_hmultimap_run *run = (misc_hmultimap_run*)misc_htable_get_or_insert(mm->ht, key, &inserted);
+    if (run == NULL) return 0;
+
+    if (run->count == run->capacity)
+    {
+        size_t capacity = run->capacity == 0 ? HMULTIMAP_MIN_RUN : run->capacity * 2;
+        void *data = NULL;
+        if (capacity <= SIZE_MAX / mm->value_size)
+        {
+            data = realloc(run->data, capacity * mm->value_size);
+        }
+
+        if (data == NULL)
+        {
+            /* Do not leave an empty run behind for a key that was just added */
+            if (inserted) misc_htable_remove(mm->ht, key);
+            return 0;
+        }
+
+        run->data = data;
+        run->capacity = capacity;
+    }
+
+    memcpy((char*)run->data + run->count * mm->value_size, value, mm->value_size);
+    run->count++;
+    mm->total++;
+
+    return 1;
+}
+
+int misc_hmultimap_get_all(const misc_hmultimap mm, const void *key, const void **values, size_t *count)
+{
+    const misc_hmultimap_run *run = NULL;
+    if (mm != NULL && key != NULL) run = (const misc_hmultimap_run*)misc_htable_get(mm->ht, key);
+
+    if (values != NULL) *values = run != NULL ? run->data : NULL;
+    if (count != NULL) *count = run != NULL ? run->count : 0;
+
+    return run != NULL;
+}
+
+int misc_hmultimap_remove_one(misc_hmultimap mm, const void *key, const void *value)
+{
+    if (mm == NULL || key == NULL || value == NULL) return 0;
+
+    misc_hmultimap_run *run = (misc_hmultimap_run*)misc_htable_get(mm->ht, key);
+    if (run == NULL) return 0;
+
+    char *data = (char*)run->data;
+    for (size_t i = 0; i < run->count; i++)
+    {
+        char *elem = data + i * mm->value_size;
+        if (memcmp(elem, value, mm->value_size) != 0) continue;
+
+        memmove(elem, elem + mm->value_size, (run->count - i - 1) * mm->value_size);
+        run->count--;
+        mm->total--;
+
+        if (run->count == 0)
+        {
+            free(run->data);
+            misc_htable_remove(mm->ht, key);
+        }
+
+        return 1;
+    }
+
+    return 0;
+}
+
+int misc_hmultimap_remove(misc_hmultimap mm, const void *key)
+{
+    if (mm == NULL || key == NULL) return 0;
+
+    misc_hmultimap_run *run = (misc_hmultimap_run*)misc_htable_get(mm->ht, key);
+    if (run == NULL) return 0;
+
+    mm->total -= run->count;
+    free(run->data);
+
+    return misc_htable_remove(mm->ht, key);
+}
+
+typedef struct misc_hmultimap_visit
+{
+
+    misc_hmultimap_visit_fn fn;
+    void *ctx;
+
+} misc_hmultimap_visit;
+
+static void _misc_hmultimap_visit_run(const void *key, void *value, void *ctx)
+{
+    const misc_hmultimap_visit *visit = (const misc_hmultimap_visit*)ctx;
+    const misc_hmultimap_run *run = (const misc_hmultimap_run*)value;
+
+    visit->fn(key, run->data, run->count, visit->ctx);
+}
+
+void misc_hmultimap_foreach(const misc_hmultimap mm, misc_hmultimap_visit_fn fn, void *ctx)
+{
+    if (mm == NULL || fn == NULL) return;
+
+    misc_hmultimap_visit visit = { fn, ctx };
+    misc_htable_foreach(mm->ht, _misc_hmultimap_visit_run, &visit);
+}
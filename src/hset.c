@@ -0,0 +1,168 @@
+#include "misc/hset.h"
+#include "misc/htable.h"
+#include <stdlib.h>
+
+
+misc_hset misc_hset_create(size_t key_size,
+                           misc_hash_fn hash_func,
+                           misc_key_cmp_fn key_cmp,
+                           int flags)
+{
+    return misc_htable_create(0, key_size, hash_func, key_cmp, flags);
+}
+
+misc_hset misc_hset_create_str(int flags)
+{
+    return misc_htable_create_str(0, flags);
+}
+
+misc_hset misc_hset_create_str_owned(int flags)
+{
+    return misc_htable_create_str_owned(0, flags);
+}
+
+misc_hset misc_hset_create_int(int flags)
+{
+    return misc_htable_create_int(0, flags);
+}
+
+misc_hset misc_hset_create_u64(int flags)
+{
+    return misc_htable_create_u64(0, flags);
+}
+
+misc_hset misc_hset_create_ptr(int flags)
+{
+    return misc_htable_create_ptr(0, flags);
+}
+
+void misc_hset_destroy(misc_hset set)
+{
+    misc_htable_destroy(set);
+}
+
+void misc_hset_clear(misc_hset set)
+{
+    misc_htable_clear(set);
+}
+
+size_t misc_hset_size(const misc_hset set)
+{
+    return misc_htable_size(set);
+}
+
+int misc_hset_add(misc_hset set, const void *key, int *added)
+{
+    return misc_htable_emplace(set, key, added) != NULL;
+}
+
+int misc_hset_contains(const misc_hset set, const void *key)
+{
+    return misc_htable_contains(set, key);
+}
+
+int misc_hset_remove(misc_hset set, const void *key)
+{
+    return misc_htable_remove(set, key);
+}
+
+void misc_hset_iter_begin(misc_hset set, misc_hset_iter *it)
+{
+    misc_htable_iter_begin(set, it);
+}
+
+int misc_hset_iter_next(misc_hset_iter *it, const void **key)
+{
+    void *k;
+    if (!misc_htable_iter_next(it, &k, NULL)) return 0;
+
+    if (key != NULL) *key = k;
+    return 1;
+}
+
+misc_hset misc_hset_union(const misc_hset a, const misc_hset b)
+{
+    if (a == NULL || b == NULL) return NULL;
+
+    misc_hset small = misc_hset_size(a) < misc_hset_size(b) ? a : b;
+    misc_hset large = small == a ? b : a;
+
+    misc_hset out = misc_htable_clone(large);
+    if (out == NULL) return NULL;
+
+    misc_hset_iter it;
+    const void *key;
+    misc_hset_iter_begin(small, &it);
+    while (misc_hset_iter_next(&it, &key))
+    {
+        if (!misc_hset_add(out, key, NULL))
+        {
+            misc_hset_destroy(out);
+            return NULL;
+        }
+    }
+
+    return out;
+}
+
+misc_hset misc_hset_intersection(const misc_hset a, const misc_hset b)
+{
+    if (a == NULL || b == NULL) return NULL;
+
+    misc_hset small = misc_hset_size(a) < misc_hset_size(b) ? a : b;
+    misc_hset large = small == a ? b : a;
+
+    misc_hset out = misc_htable_create_like(small);
+    if (out == NULL) return NULL;
+
+    misc_hset_iter it;
+    const void *key;
+    misc_hset_iter_begin(small, &it);
+    while (misc_hset_iter_next(&it, &key))
+    {
+        if (misc_hset_contains(large, key) && !misc_hset_add(out, key, NULL))
+        {
+            misc_hset_destroy(out);
+            return NULL;
+        }
+    }
+
+    return out;
+}
+
+misc_hset misc_hset_difference(const misc_hset a, const misc_hset b)
+{
+    if (a == NULL || b == NULL) return NULL;
+
+    misc_hset_iter it;
+    const void *key;
+
+    if (misc_hset_size(a) <= misc_hset_size(b))
+    {
+        misc_hset out = misc_htable_create_like(a);
+        if (out == NULL) return NULL;
+
+        misc_hset_iter_begin(a, &it);
+        while (misc_hset_iter_next(&it, &key))
+        {
+            if (!misc_hset_contains(b, key) && !misc_hset_add(out, key, NULL))
+            {
+                misc_hset_destroy(out);
+                return NULL;
+            }
+        }
+
+        return out;
+    }
+
+    misc_hset out = misc_htable_clone(a);
+    if (out == NULL) return NULL;
+
+    misc_hset_iter_begin(b, &it);
+    while (misc_hset_iter_next(&it, &key))
+    {
+        misc_hset_remove(out, key);
+    }
+
+    return out;
+}
@@ -1,36 +1,206 @@
 #include "misc/htable.h"
-#include "misc/vector.h"
-#include "misc/list.h"
+#include "hashfn.h"
+#include "fhtable_format.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HTABLE_X86 1
+#include <immintrin.h>
+#endif
 
 #define HTABLE_DEFAULT_CAPACITY 16
+#define HTABLE_MIN_CAPACITY 16
+/* Largest power of two a capacity can be doubled up to without wrapping */
+#define HTABLE_MAX_CAPACITY (((size_t)-1 >> 1) + 1)
 #define LOAD_FACTOR_THRESHOLD 0.75
+#define HTABLE_MAX_ALIGN 16
+
+/*
+ * In incremental mode, number of entries moved from the old store to the new
+ * one by each operation while a rehash is in progress. At most ten times as
+ * many empty slots are skipped per step, to bound the work done on sparse
+ * stretches of the old store.
+ */
+#define HTABLE_REHASH_STEP 16
+
+/*
+ * With MISC_HTABLE_SHRINK, the table is shrunk once its load drops below this
+ * fraction of the maximum load. It is rebuilt to half the maximum load, so it
+ * has to double in size before growing again.
+ */
+#define HTABLE_LOW_WATER 0.25
+
+/*
+ * Number of keys misc_htable_get_batch hashes and prefetches before
+ * resolving them, so that the cache misses of a whole group overlap.
+ */
+#define HTABLE_BATCH 16
+
+#if defined(__GNUC__)
+#define HTABLE_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define HTABLE_PREFETCH(p) ((void)(p))
+#endif
+
+/*
+ * Per-operation counters, compiled in only with MISC_STATS. They are updated
+ * with relaxed atomics since lookups may run concurrently under a read lock
+ * (as in misc_chtable).
+ */
+#if defined(MISC_STATS)
+#define HTABLE_STAT_ADD(ht, field, n) __atomic_fetch_add(&(ht)->counters.field, (n), __ATOMIC_RELAXED)
+#else
+#define HTABLE_STAT_ADD(ht, field, n) ((void)0)
+#endif
+
+/*
+ * Control bytes, kept in an array beside the slots. A full slot stores the
+ * top 7 bits of its key's hash (the tag), so most non-matching slots are
+ * rejected without touching the key. Empty and deleted slots have the high
+ * bit set.
+ *
+ * The first HTABLE_GROUP_MAX control bytes are mirrored after the last one,
+ * so a group of up to HTABLE_GROUP_MAX bytes can be loaded from any position
+ * without wrapping around.
+ */
+#define CTRL_EMPTY   0x80
+#define CTRL_DELETED 0xFE
+#define CTRL_ISFULL(c) (((c) & 0x80) == 0)
+
+#define HTABLE_GROUP_MAX 32
+
+/*
+ * How keys are passed in and stored. Generic keys are stored as the bytes the
+ * user passes. Owned string keys are passed as a pointer to a C string and
+ * stored as a misc_htable_strkey pointing to a copy owned by the table. The
+ * other built-in kinds are stored like generic keys, but the table knows
+ * their layout, which seeded hashing relies on.
+ */
+#define HTABLE_KEY_GENERIC   0
+#define HTABLE_KEY_OWNED_STR 1
+#define HTABLE_KEY_STR       2
+#define HTABLE_KEY_INT       3
+#define HTABLE_KEY_U64       4
+#define HTABLE_KEY_PTR       5
+
+typedef struct misc_htable_strkey
+{
+
+    const char *str;
+    size_t len;
+
+} misc_htable_strkey;
+
+/*
+ * Slot storage: the control bytes and the slot array of one table
+ * generation. A hash table normally has a single store; in incremental mode it
+ * also keeps the previous store around until all of its entries have been
+ * moved to the new one.
+ *
+ * The capacity is always a power of two, so the home slot of a hash is found
+ * by masking its low bits instead of dividing.
+ */
+typedef struct misc_htable_store
+{
+
+    uint8_t *ctrl;
+    uint8_t *slots;
+
+    size_t capacity;
+    size_t mask;
+    size_t size;
+    size_t tombstones;
+
+} misc_htable_store;
 
-typedef struct misc_htable_entry
+typedef struct misc_htable_counters
 {
 
-    void *key;
-    void *value;
+    size_t rehash_count;
+    uint64_t rehash_ns;
 
-} misc_htable_entry;
+    size_t lookups;
+    size_t hits;
+    size_t inserts;
+    size_t removes;
+
+} misc_htable_counters;
 
 struct misc_generic_hashtable
 {
 
-    misc_vector buckets;
+    misc_htable_store table;
+    misc_htable_store old;
+    size_t migrate_idx;
 
-    size_t capacity;
-    size_t size;
+    int flags;
+    size_t group_width;
 
     size_t key_size;
+    size_t input_key_size;
     size_t value_size;
+    size_t key_offset;
+    size_t value_offset;
+    size_t slot_size;
+    int key_kind;
+
+    double max_load;
+    uint64_t seed[2];
+
+    misc_htable_counters counters;
 
     misc_hash_fn hash_func;
+    misc_hash_mix_fn finalizer;
     misc_key_cmp_fn key_cmp;
 
 };
 
+/*
+ * Each slot holds the full hash of its key, followed by the key and the value.
+ * Keeping the hash lets a probe reject a tag collision without calling
+ * key_cmp, and lets entries be moved to a new store without rehashing keys.
+ */
+#define SLOT(ht, st, i)       ((st)->slots + (i) * (ht)->slot_size)
+#define SLOT_HASH(ht, st, i)  (*(size_t*)SLOT(ht, st, i))
+#define SLOT_KEY(ht, st, i)   (SLOT(ht, st, i) + (ht)->key_offset)
+#define SLOT_VALUE(ht, st, i) (SLOT(ht, st, i) + (ht)->value_offset)
+
+static inline uint64_t _misc_load_u64(const void *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uintptr_t _misc_load_ptr(const void *p)
+{
+    uintptr_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/*
+ * kind is a constant at every call site of the probe loops below, so for the
+ * word-sized key kinds the comparison is inlined and key_cmp is never called.
+ */
+static inline int _misc_slot_matches(const misc_htable ht, const misc_htable_store *st,
+                                     size_t i, size_t hash, const void *key, int kind)
+{
+    if (SLOT_HASH(ht, st, i) != hash) return 0;
+
+    if (kind == HTABLE_KEY_U64) return _misc_load_u64(SLOT_KEY(ht, st, i)) == _misc_load_u64(key);
+    if (kind == HTABLE_KEY_PTR) return _misc_load_ptr(SLOT_KEY(ht, st, i)) == _misc_load_ptr(key);
+
+    return ht->key_cmp(SLOT_KEY(ht, st, i), key) == 0;
+}
+
 
 #define FNV_OFFSET_BASIS 0xcbf29ce484222325UL
 #define FNV_PRIME        0x100000001b3UL
@@ -45,7 +215,7 @@ static size_t _misc_str_hash_fn(const void *key)
         hash ^= (unsigned char)(*str++);
         hash *= FNV_PRIME;
     }
-    
+
     return hash;
 }
 
@@ -57,15 +227,29 @@ static int _misc_str_key_cmp(const void* key1, const void *key2)
 }
 
 
-static size_t _misc_int_hash_fn(const void *key)
+static size_t _misc_strkey_hash_fn(const void *key)
+{
+    const misc_htable_strkey *k = (const misc_htable_strkey*)key;
+    return (size_t)_misc_wyhash(k->str, k->len, 0);
+}
+
+static int _misc_strkey_cmp(const void *key1, const void *key2)
 {
-    size_t x = (size_t)(*(const int*)key);
+    const misc_htable_strkey *k1 = (const misc_htable_strkey*)key1;
+    const misc_htable_strkey *k2 = (const misc_htable_strkey*)key2;
+
+    if (k1->len != k2->len) return 1;
+    return memcmp(k1->str, k2->str, k1->len);
+}
 
-    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
-    x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
-    x =  x ^ (x >> 31);
 
-    return x;
+/*
+ * The integer itself: spreading it across the table is left to the
+ * finalizer.
+ */
+static size_t _misc_int_hash_fn(const void *key)
+{
+    return (size_t)(*(const int*)key);
 }
 
 
@@ -81,310 +265,1624 @@ static int _misc_int_key_cmp(const void *key1, const void *key2)
 }
 
 
-misc_htable misc_htable_create(size_t value_size, size_t key_size,
-                               misc_hash_fn hash_func, 
-                               misc_key_cmp_fn key_cmp)
+/*
+ * 64-bit integer and pointer keys. Like int keys, they are spread by the
+ * finalizer. These functions are never called: _misc_htable_hash reads the
+ * key word directly for both kinds and _misc_slot_matches compares it inline.
+ * They only fill in hash_func and key_cmp, which every table must have, and
+ * document what the inlined code computes.
+ */
+static size_t _misc_u64_hash_fn(const void *key)
 {
-    if (value_size == 0 || key_size == 0) return NULL;
-    if (hash_func == NULL || key_cmp == NULL) return NULL;
+    return (size_t)_misc_load_u64(key);
+}
+
+
+static int _misc_u64_key_cmp(const void *key1, const void *key2)
+{
+    return _misc_load_u64(key1) != _misc_load_u64(key2);
+}
+
+
+static size_t _misc_ptr_hash_fn(const void *key)
+{
+    return (size_t)_misc_load_ptr(key);
+}
+
+
+static int _misc_ptr_key_cmp(const void *key1, const void *key2)
+{
+    return _misc_load_ptr(key1) != _misc_load_ptr(key2);
+}
 
-    misc_htable ht = (misc_htable)malloc(sizeof(struct misc_generic_hashtable));
-    if (ht == NULL) return NULL;
 
-    ht->buckets = misc_vector_create(sizeof(misc_list));
-    if (ht->buckets == NULL)
+/*
+ * SipHash-1-3, keyed with the table's random seed. Without the seed, the
+ * output for a given key cannot be predicted, so colliding keys cannot be
+ * computed offline.
+ */
+#define SIP_ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+#define SIP_ROUND(v0, v1, v2, v3)                                  \
+    do                                                             \
+    {                                                              \
+        v0 += v1; v1 = SIP_ROTL(v1, 13); v1 ^= v0; v0 = SIP_ROTL(v0, 32); \
+        v2 += v3; v3 = SIP_ROTL(v3, 16); v3 ^= v2;                \
+        v0 += v3; v3 = SIP_ROTL(v3, 21); v3 ^= v0;                \
+        v2 += v1; v1 = SIP_ROTL(v1, 17); v1 ^= v2; v2 = SIP_ROTL(v2, 32); \
+    } while (0)
+
+static uint64_t _misc_siphash13(const uint64_t seed[2], const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t*)data;
+    uint64_t v0 = 0x736f6d6570736575ULL ^ seed[0];
+    uint64_t v1 = 0x646f72616e646f6dULL ^ seed[1];
+    uint64_t v2 = 0x6c7967656e657261ULL ^ seed[0];
+    uint64_t v3 = 0x7465646279746573ULL ^ seed[1];
+    uint64_t b = (uint64_t)len << 56;
+
+    for (; len >= 8; len -= 8, p += 8)
     {
-        free(ht);
-        return NULL;
+        uint64_t m = _misc_wyr8(p);
+        v3 ^= m;
+        SIP_ROUND(v0, v1, v2, v3);
+        v0 ^= m;
     }
 
-    for (size_t i = 0; i < HTABLE_DEFAULT_CAPACITY; i++)
+    for (size_t i = 0; i < len; i++)
     {
-        misc_list bucket = NULL;
-        misc_vector_pushback(ht->buckets, &bucket);
+        b |= (uint64_t)p[i] << (8 * i);
     }
 
-    ht->capacity = HTABLE_DEFAULT_CAPACITY;
-    ht->size = 0;
-    ht->key_size = key_size;
-    ht->value_size = value_size;
-    ht->hash_func = hash_func;
-    ht->key_cmp = key_cmp;
+    v3 ^= b;
+    SIP_ROUND(v0, v1, v2, v3);
+    v0 ^= b;
 
-    return ht;
+    v2 ^= 0xff;
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+
+    return v0 ^ v1 ^ v2 ^ v3;
 }
 
-misc_htable misc_htable_create_str(size_t value_size)
+/*
+ * Fills seed with random bytes from the system, falling back to a mix of the
+ * clock and the table's address where /dev/urandom is not available.
+ */
+static void _misc_random_seed(uint64_t seed[2], const void *salt)
 {
-    return misc_htable_create(value_size, sizeof(char*), _misc_str_hash_fn, _misc_str_key_cmp);
+    FILE *f = fopen("/dev/urandom", "rb");
+    if (f != NULL)
+    {
+        size_t n = fread(seed, sizeof(uint64_t), 2, f);
+        fclose(f);
+        if (n == 2) return;
+    }
+
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    seed[0] = _misc_splitmix_fn((size_t)ts.tv_nsec ^ (size_t)salt);
+    seed[1] = _misc_splitmix_fn((size_t)ts.tv_sec ^ (size_t)seed[0]);
 }
 
-misc_htable misc_htable_create_int(size_t value_size)
+static uint64_t _misc_now_ns(void)
 {
-    return misc_htable_create(value_size, sizeof(int), _misc_int_hash_fn, _misc_int_key_cmp);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
 }
 
-void misc_htable_destroy(misc_htable ht)
+/*
+ * Seeded mode: built-in key types are hashed with SipHash over their bytes.
+ * Keys hashed by a user function can only have the seed mixed into the hash,
+ * which changes where keys land but cannot split keys the user function
+ * already maps to the same value.
+ */
+static size_t _misc_htable_hash_seeded(const misc_htable ht, const void *key)
 {
-    if (ht == NULL) return;
-
-    for (size_t i = 0; i < ht->capacity; i++)
+    switch (ht->key_kind)
     {
-        misc_list *bucket = (misc_list*)misc_vector_get(ht->buckets, i);
-        if (*bucket != NULL)
+        case HTABLE_KEY_STR:
         {
-            size_t list_size = misc_list_size(*bucket);
-            for (size_t j = 0; j < list_size; j++)
-            {
-                misc_htable_entry *entry = (misc_htable_entry*)misc_list_get(*bucket, j);
-                free(entry->key);
-                free(entry->value);
-            }
-            misc_list_destroy(*bucket);
+            const char *str = *(const char**)key;
+            return (size_t)_misc_siphash13(ht->seed, str, strlen(str));
+        }
+        case HTABLE_KEY_OWNED_STR:
+        {
+            const misc_htable_strkey *k = (const misc_htable_strkey*)key;
+            return (size_t)_misc_siphash13(ht->seed, k->str, k->len);
         }
+        case HTABLE_KEY_INT:
+            return (size_t)_misc_siphash13(ht->seed, key, sizeof(int));
+        case HTABLE_KEY_U64:
+            return (size_t)_misc_siphash13(ht->seed, key, sizeof(uint64_t));
+        case HTABLE_KEY_PTR:
+            return (size_t)_misc_siphash13(ht->seed, key, sizeof(uintptr_t));
+        default:
+            return ht->hash_func(key) ^ (size_t)ht->seed[0];
     }
+}
 
-    misc_vector_destroy(ht->buckets);
-    free(ht);
+static inline size_t _misc_htable_hash(const misc_htable ht, const void *key)
+{
+    size_t hash;
+
+    if (ht->flags & MISC_HTABLE_SEEDED) hash = _misc_htable_hash_seeded(ht, key);
+    else if (ht->key_kind == HTABLE_KEY_U64) hash = (size_t)_misc_load_u64(key);
+    else if (ht->key_kind == HTABLE_KEY_PTR) hash = (size_t)_misc_load_ptr(key);
+    else hash = ht->hash_func(key);
+
+    /* The default finalizer is tested for explicitly so it gets inlined */
+    if (ht->finalizer == _misc_splitmix_fn) return _misc_splitmix_fn(hash);
+    if (ht->finalizer != NULL) return ht->finalizer(hash);
+
+    return hash;
 }
 
-void misc_htable_clear(misc_htable ht)
+
+/*
+ * Turns a key as passed by the user into the form stored in the slots, using
+ * tmp as storage if needed.
+ */
+static inline const void* _misc_htable_key(const misc_htable ht, const void *key, misc_htable_strkey *tmp)
 {
-    if (ht == NULL) return;
+    if (ht->key_kind != HTABLE_KEY_OWNED_STR) return key;
 
-    for (size_t i = 0; i < ht->capacity; i++)
-    {
-        misc_list *bucket = (misc_list*)misc_vector_get(ht->buckets, i);
-        if (*bucket != NULL)
-        {
-            size_t list_size = misc_list_size(*bucket);
-            for (size_t j = 0; j < list_size; j++)
-            {
-                misc_htable_entry *entry = (misc_htable_entry*)misc_list_get(*bucket, j);
-                free(entry->key);
-                free(entry->value);
-            }
-            misc_list_clear(*bucket);
-        }
-    }
+    tmp->str = *(const char**)key;
+    tmp->len = strlen(tmp->str);
+    return tmp;
+}
 
-    ht->size = 0;
+/*
+ * Largest power of two dividing size (capped at HTABLE_MAX_ALIGN). Any C type
+ * has a size that is a multiple of its alignment, so this is always a safe
+ * alignment for a key or value of that size.
+ */
+static size_t _misc_size_align(size_t size)
+{
+    size_t align = size & (~size + 1);
+    return align > HTABLE_MAX_ALIGN ? HTABLE_MAX_ALIGN : align;
 }
 
-size_t misc_htable_size(const misc_htable ht)
+static size_t _misc_round_up(size_t n, size_t align)
 {
-    if (ht == NULL) return 0;
-    return ht->size;
+    return (n + align - 1) & ~(align - 1);
 }
 
-int misc_htable_contains(const misc_htable ht, const void *key)
+static uint8_t _misc_hash_tag(size_t hash)
 {
-    if (ht == NULL || key == NULL) return 0;
+    return (uint8_t)(hash >> (sizeof(size_t) * 8 - 7));
+}
+
+static void _misc_set_ctrl(uint8_t *ctrl, size_t capacity, size_t i, uint8_t c)
+{
+    ctrl[i] = c;
+    for (size_t j = i + capacity; j < capacity + HTABLE_GROUP_MAX; j += capacity)
+    {
+        ctrl[j] = c;
+    }
+}
 
-    size_t hash = ht->hash_func(key);
-    size_t bucket_idx = hash % ht->capacity;
+/*
+ * A store is a single allocation: the slot array, whose start is suitably
+ * aligned for any key and value, followed by the control bytes. Creating or
+ * freeing a table generation costs one malloc and one free regardless of the
+ * number of entries.
+ */
+static int _misc_store_alloc(misc_htable_store *st, size_t capacity, size_t slot_size)
+{
+    /* Slots, control bytes and the mirrored group must fit in a size_t */
+    if (capacity > (SIZE_MAX - HTABLE_GROUP_MAX) / (slot_size + 1))
+    {
+        st->slots = NULL;
+        st->ctrl = NULL;
+        return 0;
+    }
 
-    misc_list *bucket = (misc_list*)misc_vector_get(ht->buckets, bucket_idx);
-    if (*bucket == NULL) return 0;
+    size_t slots_bytes = capacity * slot_size;
 
-    size_t list_size = misc_list_size(*bucket);
-    for (size_t i = 0; i < list_size; i++)
+    st->slots = (uint8_t*)malloc(slots_bytes + capacity + HTABLE_GROUP_MAX);
+    if (st->slots == NULL)
     {
-        misc_htable_entry *entry = (misc_htable_entry*)misc_list_get(*bucket, i);
-        if (ht->key_cmp(entry->key, key) == 0)
-        {
-            return 1;
-        }
+        st->ctrl = NULL;
+        return 0;
     }
 
-    return 0;
+    st->ctrl = st->slots + slots_bytes;
+    memset(st->ctrl, CTRL_EMPTY, capacity + HTABLE_GROUP_MAX);
+
+    st->capacity = capacity;
+    st->mask = capacity - 1;
+    st->size = 0;
+    st->tombstones = 0;
+
+    return 1;
 }
 
-void* misc_htable_get(const misc_htable ht, const void *key)
+static void _misc_store_free(misc_htable_store *st)
 {
-    if (ht == NULL || key == NULL) return NULL;
-
-    size_t hash = ht->hash_func(key);
-    size_t bucket_idx = hash % ht->capacity;
+    free(st->slots);
+    st->ctrl = NULL;
+    st->slots = NULL;
+}
 
-    misc_list *bucket = (misc_list*)misc_vector_get(ht->buckets, bucket_idx);
-    if (*bucket == NULL) return NULL;
+/*
+ * Scalar probe: walks the control bytes one at a time from the key's home
+ * slot. Returns the index of the slot holding key, or st->capacity if the key
+ * is not in the store.
+ */
+static inline size_t _misc_store_find_scalar(const misc_htable ht, const misc_htable_store *st,
+                                             const void *key, size_t hash, int kind)
+{
+    uint8_t tag = _misc_hash_tag(hash);
+    size_t idx = hash & st->mask;
 
-    size_t list_size = misc_list_size(*bucket);
-    for (size_t i = 0; i < list_size; i++)
+    while (st->ctrl[idx] != CTRL_EMPTY)
     {
-        misc_htable_entry *entry = (misc_htable_entry*)misc_list_get(*bucket, i);
-        if (ht->key_cmp(entry->key, key) == 0)
+        if (st->ctrl[idx] == tag && _misc_slot_matches(ht, st, idx, hash, key, kind))
         {
-            return entry->value;
+            return idx;
         }
+        idx = (idx + 1) & st->mask;
     }
 
-    return NULL;
+    return st->capacity;
 }
 
-static int _misc_htable_rehash(misc_htable ht)
+/*
+ * Group matchers: return a bitmask of the bytes in the group equal to tag,
+ * and store in *empty the bitmask of the empty ones.
+ */
+static inline uint32_t _misc_group_match16(const uint8_t *ctrl, uint8_t tag, uint32_t *empty)
 {
-    if (ht == NULL) return 0;
-
-    size_t old_capacity = ht->capacity;
-    size_t new_capacity = old_capacity * 2;
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    *empty = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)CTRL_EMPTY)));
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)tag)));
+#else
+    uint32_t match = 0;
+    *empty = 0;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        if (ctrl[i] == tag) match |= 1u << i;
+        if (ctrl[i] == CTRL_EMPTY) *empty |= 1u << i;
+    }
+    return match;
+#endif
+}
 
-    misc_vector new_buckets = misc_vector_create(sizeof(misc_list));
-    if (new_buckets == NULL) return 0;
+/*
+ * Group probe: checks a whole group of control bytes per step and only calls
+ * key_cmp on slots whose tag matches. Matches past the first empty slot of
+ * the group belong to other probe sequences and are dropped.
+ */
+static inline size_t _misc_store_find_group16(const misc_htable ht, const misc_htable_store *st,
+                                              const void *key, size_t hash, int kind)
+{
+    uint8_t tag = _misc_hash_tag(hash);
+    size_t pos = hash & st->mask;
 
-    for (size_t i = 0; i < new_capacity; i++)
+    for (;;)
     {
-        misc_list bucket = NULL;
-        if (!misc_vector_pushback(new_buckets, &bucket))
+        uint32_t empty;
+        uint32_t match = _misc_group_match16(st->ctrl + pos, tag, &empty);
+        if (empty) match &= (empty & (~empty + 1)) - 1;
+
+        while (match)
         {
-            misc_vector_destroy(new_buckets);
-            return 0;
+            size_t idx = (pos + (size_t)__builtin_ctz(match)) & st->mask;
+            if (_misc_slot_matches(ht, st, idx, hash, key, kind)) return idx;
+            match &= match - 1;
         }
+
+        if (empty) return st->capacity;
+        pos = (pos + 16) & st->mask;
     }
+}
+
+#if defined(HTABLE_X86)
+__attribute__((target("avx2")))
+static size_t _misc_store_find_group32(const misc_htable ht, const misc_htable_store *st,
+                                       const void *key, size_t hash, int kind)
+{
+    uint8_t tag = _misc_hash_tag(hash);
+    size_t pos = hash & st->mask;
+    __m256i tags = _mm256_set1_epi8((char)tag);
+    __m256i empties = _mm256_set1_epi8((char)CTRL_EMPTY);
 
-    for (size_t i = 0; i < old_capacity; i++)
+    for (;;)
     {
-        misc_list *old_bucket = (misc_list*)misc_vector_get(ht->buckets, i);
-        if (*old_bucket == NULL) continue;
+        __m256i group = _mm256_loadu_si256((const __m256i*)(st->ctrl + pos));
+        uint32_t empty = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, empties));
+        uint32_t match = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, tags));
+        if (empty) match &= (empty & (~empty + 1)) - 1;
 
-        size_t list_size = misc_list_size(*old_bucket);
-        for (size_t j = 0; j < list_size; j++)
+        while (match)
         {
-            misc_htable_entry *entry = (misc_htable_entry*)misc_list_get(*old_bucket, j);
-            
-            size_t hash = ht->hash_func(entry->key);
-            size_t new_bucket_idx = hash % new_capacity;
-
-            misc_list *new_bucket = (misc_list*)misc_vector_get(new_buckets, new_bucket_idx);
-            
-            if (*new_bucket == NULL)
-            {
-                *new_bucket = misc_list_create(sizeof(misc_htable_entry));
-                if (*new_bucket == NULL)
-                {
-                    for (size_t k = 0; k < new_capacity; k++)
-                    {
-                        misc_list *b = (misc_list*)misc_vector_get(new_buckets, k);
-                        if (*b != NULL) misc_list_destroy(*b);
-                    }
-                    misc_vector_destroy(new_buckets);
-                    return 0;
-                }
-            }
-
-            if (!misc_list_pushback(*new_bucket, entry))
-            {
-                for (size_t k = 0; k < new_capacity; k++)
-                {
-                    misc_list *b = (misc_list*)misc_vector_get(new_buckets, k);
-                    if (*b != NULL) misc_list_destroy(*b);
-                }
-                misc_vector_destroy(new_buckets);
-                return 0;
-            }
+            size_t idx = (pos + (size_t)__builtin_ctz(match)) & st->mask;
+            if (_misc_slot_matches(ht, st, idx, hash, key, kind)) return idx;
+            match &= match - 1;
         }
+
+        if (empty) return st->capacity;
+        pos = (pos + 32) & st->mask;
     }
+}
+#endif
 
-    for (size_t i = 0; i < old_capacity; i++)
+static inline size_t _misc_store_find_kind(const misc_htable ht, const misc_htable_store *st,
+                                           const void *key, size_t hash, int kind)
+{
+    if (!(ht->flags & MISC_HTABLE_GROUP_PROBE))
     {
-        misc_list *old_bucket = (misc_list*)misc_vector_get(ht->buckets, i);
-        if (*old_bucket != NULL)
-        {
-            misc_list_destroy(*old_bucket);
-        }
+        return _misc_store_find_scalar(ht, st, key, hash, kind);
+    }
+
+#if defined(HTABLE_X86)
+    if (ht->group_width == 32)
+    {
+        return _misc_store_find_group32(ht, st, key, hash, kind);
     }
-    misc_vector_destroy(ht->buckets);
+#endif
 
-    ht->buckets = new_buckets;
-    ht->capacity = new_capacity;
+    return _misc_store_find_group16(ht, st, key, hash, kind);
+}
 
-    return 1;
+/*
+ * Dispatches once on the key kind so that each word-sized kind gets its own
+ * copy of the probe loops, with the key comparison inlined.
+ */
+static size_t _misc_store_find(const misc_htable ht, const misc_htable_store *st,
+                               const void *key, size_t hash)
+{
+    switch (ht->key_kind)
+    {
+        case HTABLE_KEY_U64:
+            return _misc_store_find_kind(ht, st, key, hash, HTABLE_KEY_U64);
+        case HTABLE_KEY_PTR:
+            return _misc_store_find_kind(ht, st, key, hash, HTABLE_KEY_PTR);
+        default:
+            return _misc_store_find_kind(ht, st, key, hash, HTABLE_KEY_GENERIC);
+    }
 }
 
-int misc_htable_put(misc_htable ht, const void *key, const void *value)
+/*
+ * Like _misc_store_find, but on a miss returns the slot where key should be
+ * inserted (the first tombstone met along the probe, or the terminating empty
+ * slot) and sets *found to 0.
+ */
+static inline size_t _misc_store_find_insert_kind(const misc_htable ht, const misc_htable_store *st,
+                                                  const void *key, size_t hash, int *found, int kind)
 {
-    if (ht == NULL || key == NULL || value == NULL) return 0;
+    uint8_t tag = _misc_hash_tag(hash);
+    size_t idx = hash & st->mask;
+    size_t insert_idx = st->capacity;
 
-    double load_factor = (double)ht->size / (double)ht->capacity;
-    if (load_factor >= LOAD_FACTOR_THRESHOLD)
+    while (st->ctrl[idx] != CTRL_EMPTY)
     {
-        if (!_misc_htable_rehash(ht))
+        if (CTRL_ISFULL(st->ctrl[idx]))
         {
-            return 0;
+            if (st->ctrl[idx] == tag && _misc_slot_matches(ht, st, idx, hash, key, kind))
+            {
+                *found = 1;
+                return idx;
+            }
+        }
+        else if (insert_idx == st->capacity)
+        {
+            insert_idx = idx;
         }
+        idx = (idx + 1) & st->mask;
+    }
+
+    *found = 0;
+    return insert_idx == st->capacity ? idx : insert_idx;
+}
+
+static size_t _misc_store_find_insert(const misc_htable ht, const misc_htable_store *st,
+                                      const void *key, size_t hash, int *found)
+{
+    switch (ht->key_kind)
+    {
+        case HTABLE_KEY_U64:
+            return _misc_store_find_insert_kind(ht, st, key, hash, found, HTABLE_KEY_U64);
+        case HTABLE_KEY_PTR:
+            return _misc_store_find_insert_kind(ht, st, key, hash, found, HTABLE_KEY_PTR);
+        default:
+            return _misc_store_find_insert_kind(ht, st, key, hash, found, HTABLE_KEY_GENERIC);
+    }
+}
+
+/*
+ * Copies a whole slot (hash, key and value) into st, which must not already
+ * hold the key. Used when moving entries between stores.
+ */
+static void _misc_store_move_in(const misc_htable ht, misc_htable_store *st, const uint8_t *slot)
+{
+    size_t hash = *(const size_t*)slot;
+    size_t idx = hash & st->mask;
+    while (CTRL_ISFULL(st->ctrl[idx]))
+    {
+        idx = (idx + 1) & st->mask;
     }
 
-    size_t hash = ht->hash_func(key);
-    size_t bucket_idx = hash % ht->capacity;
+    if (st->ctrl[idx] == CTRL_DELETED) st->tombstones--;
+
+    _misc_set_ctrl(st->ctrl, st->capacity, idx, _misc_hash_tag(hash));
+    memcpy(SLOT(ht, st, idx), slot, ht->slot_size);
+    st->size++;
+}
 
-    misc_list *bucket = (misc_list*)misc_vector_get(ht->buckets, bucket_idx);
-    
-    if (*bucket == NULL)
+static void _misc_store_erase(misc_htable_store *st, size_t idx)
+{
+    /*
+     * A tombstone is only needed if some probe sequence may run past this
+     * slot; when the next slot is empty no probe does, so it can be freed.
+     */
+    if (st->ctrl[(idx + 1) & st->mask] == CTRL_EMPTY)
+    {
+        _misc_set_ctrl(st->ctrl, st->capacity, idx, CTRL_EMPTY);
+    }
+    else
     {
-        *bucket = misc_list_create(sizeof(misc_htable_entry));
-        if (*bucket == NULL) return 0;
+        _misc_set_ctrl(st->ctrl, st->capacity, idx, CTRL_DELETED);
+        st->tombstones++;
     }
 
-    size_t list_size = misc_list_size(*bucket);
-    for (size_t i = 0; i < list_size; i++)
+    st->size--;
+}
+
+/*
+ * Moves up to n entries from the old store to the current one, continuing
+ * from where the previous step stopped. Migrated slots are turned into
+ * tombstones so that probes for the entries still in the old store keep
+ * running past them. Frees the old store once it has been fully walked.
+ */
+static void _misc_htable_migrate(misc_htable ht, size_t n)
+{
+    misc_htable_store *old = &ht->old;
+    size_t empty_visits = n * 10;
+
+#if defined(MISC_STATS)
+    uint64_t start = _misc_now_ns();
+#endif
+
+    while (n > 0 && ht->migrate_idx < old->capacity)
     {
-        misc_htable_entry *entry = (misc_htable_entry*)misc_list_get(*bucket, i);
-        if (ht->key_cmp(entry->key, key) == 0)
+        size_t i = ht->migrate_idx++;
+
+        if (!CTRL_ISFULL(old->ctrl[i]))
         {
-            memcpy(entry->value, value, ht->value_size);
-            return 1;
+            if (--empty_visits == 0) break;
+            continue;
         }
+
+        _misc_store_move_in(ht, &ht->table, SLOT(ht, old, i));
+        _misc_set_ctrl(old->ctrl, old->capacity, i, CTRL_DELETED);
+        old->size--;
+        n--;
     }
 
-    misc_htable_entry new_entry;
-    new_entry.key = malloc(ht->key_size);
-    new_entry.value = malloc(ht->value_size);
-    
-    if (new_entry.key == NULL || new_entry.value == NULL)
+    if (ht->migrate_idx == old->capacity)
     {
-        if (new_entry.key != NULL) free(new_entry.key);
-        if (new_entry.value != NULL) free(new_entry.value);
-        return 0;
+        _misc_store_free(old);
     }
 
-    memcpy(new_entry.key, key, ht->key_size);
-    memcpy(new_entry.value, value, ht->value_size);
+#if defined(MISC_STATS)
+    HTABLE_STAT_ADD(ht, rehash_ns, _misc_now_ns() - start);
+#endif
+}
+
+/*
+ * Finds the store and slot holding key. Returns NULL if the key is in
+ * neither the current store nor, while a rehash is in progress, the old one.
+ */
+static misc_htable_store* _misc_htable_locate(const misc_htable ht, const void *key, size_t *idx)
+{
+    misc_htable_strkey tmp;
+    key = _misc_htable_key(ht, key, &tmp);
+    size_t hash = _misc_htable_hash(ht, key);
+
+    *idx = _misc_store_find(ht, &ht->table, key, hash);
+    if (*idx != ht->table.capacity) return &ht->table;
 
-    if (!misc_list_pushback(*bucket, &new_entry))
+    if (ht->old.ctrl != NULL)
     {
-        free(new_entry.key);
-        free(new_entry.value);
-        return 0;
+        *idx = _misc_store_find(ht, &ht->old, key, hash);
+        if (*idx != ht->old.capacity) return &ht->old;
     }
 
-    ht->size++;
-    return 1;
+    return NULL;
 }
 
-int misc_htable_remove(misc_htable ht, const void *key)
+
+misc_htable misc_htable_create_ex(size_t value_size, size_t key_size,
+                                  misc_hash_fn hash_func,
+                                  misc_key_cmp_fn key_cmp,
+                                  int flags,
+                                  size_t initial_capacity,
+                                  double max_load)
 {
-    if (ht == NULL || key == NULL) return 0;
+    if (key_size == 0) return NULL;
+    if (hash_func == NULL || key_cmp == NULL) return NULL;
+    if (!(max_load > 0.0 && max_load < 1.0)) return NULL;
+
+    size_t capacity = HTABLE_MIN_CAPACITY;
+    while (capacity < initial_capacity)
+    {
+        if (capacity == HTABLE_MAX_CAPACITY) return NULL;
+        capacity *= 2;
+    }
+
+    misc_htable ht = (misc_htable)malloc(sizeof(struct misc_generic_hashtable));
+    if (ht == NULL) return NULL;
 
-    size_t hash = ht->hash_func(key);
-    size_t bucket_idx = hash % ht->capacity;
+    size_t key_align = _misc_size_align(key_size);
+    /* Key-only tables (value_size 0) store no value bytes */
+    size_t value_align = value_size == 0 ? 1 : _misc_size_align(value_size);
+    size_t slot_align = key_align > value_align ? key_align : value_align;
+    if (slot_align < sizeof(size_t)) slot_align = sizeof(size_t);
 
-    misc_list *bucket = (misc_list*)misc_vector_get(ht->buckets, bucket_idx);
-    if (*bucket == NULL) return 0;
+    ht->key_size = key_size;
+    ht->input_key_size = key_size;
+    ht->value_size = value_size;
+    ht->key_offset = _misc_round_up(sizeof(size_t), key_align);
+    ht->value_offset = _misc_round_up(ht->key_offset + key_size, value_align);
+    ht->slot_size = _misc_round_up(ht->value_offset + value_size, slot_align);
+    ht->key_kind = HTABLE_KEY_GENERIC;
+    ht->max_load = max_load;
 
-    size_t list_size = misc_list_size(*bucket);
-    for (size_t i = 0; i < list_size; i++)
+    if (!_misc_store_alloc(&ht->table, capacity, ht->slot_size))
     {
-        misc_htable_entry *entry = (misc_htable_entry*)misc_list_get(*bucket, i);
-        if (ht->key_cmp(entry->key, key) == 0)
-        {
-            free(entry->key);
-            free(entry->value);
-            misc_list_remove(*bucket, i, NULL);
-            ht->size--;
-            return 1;
-        }
+        free(ht);
+        return NULL;
     }
 
-    return 0;
+    ht->old.ctrl = NULL;
+    ht->old.slots = NULL;
+    ht->old.capacity = 0;
+    ht->old.size = 0;
+    ht->old.tombstones = 0;
+    ht->migrate_idx = 0;
+
+    memset(&ht->counters, 0, sizeof(ht->counters));
+
+    ht->flags = flags;
+    if (flags & MISC_HTABLE_SEEDED) _misc_random_seed(ht->seed, ht);
+    else ht->seed[0] = ht->seed[1] = 0;
+
+    ht->hash_func = hash_func;
+    ht->finalizer = _misc_splitmix_fn;
+    ht->key_cmp = key_cmp;
+
+    ht->group_width = 16;
+#if defined(HTABLE_X86)
+    if (__builtin_cpu_supports("avx2")) ht->group_width = 32;
+#endif
+
+    return ht;
+}
+
+misc_htable misc_htable_create(size_t value_size, size_t key_size,
+                               misc_hash_fn hash_func,
+                               misc_key_cmp_fn key_cmp,
+                               int flags)
+{
+    return misc_htable_create_ex(value_size, key_size, hash_func, key_cmp, flags,
+                                 HTABLE_DEFAULT_CAPACITY, LOAD_FACTOR_THRESHOLD);
+}
+
+misc_htable misc_htable_create_str(size_t value_size, int flags)
+{
+    misc_htable ht = misc_htable_create(value_size, sizeof(char*), _misc_str_hash_fn, _misc_str_key_cmp, flags);
+    if (ht == NULL) return NULL;
+
+    ht->key_kind = HTABLE_KEY_STR;
+    return ht;
+}
+
+misc_htable misc_htable_create_int(size_t value_size, int flags)
+{
+    misc_htable ht = misc_htable_create(value_size, sizeof(int), _misc_int_hash_fn, _misc_int_key_cmp, flags);
+    if (ht == NULL) return NULL;
+
+    ht->key_kind = HTABLE_KEY_INT;
+    return ht;
+}
+
+misc_htable misc_htable_create_u64(size_t value_size, int flags)
+{
+    misc_htable ht = misc_htable_create(value_size, sizeof(uint64_t), _misc_u64_hash_fn, _misc_u64_key_cmp, flags);
+    if (ht == NULL) return NULL;
+
+    ht->key_kind = HTABLE_KEY_U64;
+    return ht;
+}
+
+misc_htable misc_htable_create_i64(size_t value_size, int flags)
+{
+    /* Two's complement: equal int64_t keys have equal bit patterns */
+    return misc_htable_create_u64(value_size, flags);
+}
+
+misc_htable misc_htable_create_ptr(size_t value_size, int flags)
+{
+    misc_htable ht = misc_htable_create(value_size, sizeof(uintptr_t), _misc_ptr_hash_fn, _misc_ptr_key_cmp, flags);
+    if (ht == NULL) return NULL;
+
+    ht->key_kind = HTABLE_KEY_PTR;
+    return ht;
+}
+
+misc_htable misc_htable_create_str_owned(size_t value_size, int flags)
+{
+    misc_htable ht = misc_htable_create(value_size, sizeof(misc_htable_strkey),
+                                        _misc_strkey_hash_fn, _misc_strkey_cmp, flags);
+    if (ht == NULL) return NULL;
+
+    /* Callers pass a char*, which the table turns into a misc_htable_strkey */
+    ht->key_kind = HTABLE_KEY_OWNED_STR;
+    ht->input_key_size = sizeof(char*);
+    return ht;
+}
+
+static void _misc_store_free_keys(const misc_htable ht, const misc_htable_store *st)
+{
+    if (st->ctrl == NULL) return;
+
+    for (size_t i = 0; i < st->capacity; i++)
+    {
+        if (CTRL_ISFULL(st->ctrl[i])) free((void*)((misc_htable_strkey*)SLOT_KEY(ht, st, i))->str);
+    }
+}
+
+/*
+ * Copies src into dst, which must have been allocated with the same capacity.
+ * Owned string keys are duplicated; if that fails, the keys not yet copied
+ * are set to NULL so that the clone can still be destroyed.
+ */
+static int _misc_store_copy(const misc_htable ht, misc_htable_store *dst, const misc_htable_store *src)
+{
+    memcpy(dst->slots, src->slots, src->capacity * ht->slot_size + src->capacity + HTABLE_GROUP_MAX);
+    dst->size = src->size;
+    dst->tombstones = src->tombstones;
+
+    if (ht->key_kind != HTABLE_KEY_OWNED_STR) return 1;
+
+    int ok = 1;
+    for (size_t i = 0; i < dst->capacity; i++)
+    {
+        if (!CTRL_ISFULL(dst->ctrl[i])) continue;
+
+        misc_htable_strkey *k = (misc_htable_strkey*)SLOT_KEY(ht, dst, i);
+        char *copy = ok ? (char*)malloc(k->len + 1) : NULL;
+        if (copy != NULL) memcpy(copy, k->str, k->len + 1);
+        else ok = 0;
+
+        k->str = copy;
+    }
+
+    return ok;
+}
+
+misc_htable misc_htable_create_like(const misc_htable ht)
+{
+    if (ht == NULL) return NULL;
+
+    misc_htable like = (misc_htable)malloc(sizeof(struct misc_generic_hashtable));
+    if (like == NULL) return NULL;
+
+    *like = *ht;
+    if (!_misc_store_alloc(&like->table, HTABLE_MIN_CAPACITY, ht->slot_size))
+    {
+        free(like);
+        return NULL;
+    }
+
+    memset(&like->old, 0, sizeof(like->old));
+    memset(&like->counters, 0, sizeof(like->counters));
+    like->migrate_idx = 0;
+
+    if (like->flags & MISC_HTABLE_SEEDED) _misc_random_seed(like->seed, like);
+
+    return like;
+}
+
+misc_htable misc_htable_clone(const misc_htable ht)
+{
+    if (ht == NULL) return NULL;
+
+    misc_htable clone = (misc_htable)malloc(sizeof(struct misc_generic_hashtable));
+    if (clone == NULL) return NULL;
+
+    /* The seed is kept: the cached hashes in the copied slots depend on it */
+    *clone = *ht;
+    memset(&clone->old, 0, sizeof(clone->old));
+    memset(&clone->counters, 0, sizeof(clone->counters));
+
+    if (!_misc_store_alloc(&clone->table, ht->table.capacity, ht->slot_size))
+    {
+        free(clone);
+        return NULL;
+    }
+
+    int ok = _misc_store_copy(ht, &clone->table, &ht->table);
+
+    if (ok && ht->old.ctrl != NULL)
+    {
+        ok = _misc_store_alloc(&clone->old, ht->old.capacity, ht->slot_size) &&
+             _misc_store_copy(ht, &clone->old, &ht->old);
+    }
+
+    if (!ok)
+    {
+        misc_htable_destroy(clone);
+        return NULL;
+    }
+
+    return clone;
+}
+
+int misc_htable_set_finalizer(misc_htable ht, misc_hash_mix_fn finalizer)
+{
+    if (ht == NULL) return 0;
+    if (ht->finalizer == finalizer) return 1;
+
+    if (ht->old.ctrl != NULL) _misc_htable_migrate(ht, ht->old.capacity);
+
+    uint64_t start = _misc_now_ns();
+
+    misc_htable_store new_table;
+    if (!_misc_store_alloc(&new_table, ht->table.capacity, ht->slot_size)) return 0;
+
+    ht->finalizer = finalizer;
+
+    /* The cached hashes are stale now, so every entry is hashed again */
+    for (size_t i = 0; i < ht->table.capacity; i++)
+    {
+        if (!CTRL_ISFULL(ht->table.ctrl[i])) continue;
+
+        uint8_t *slot = SLOT(ht, &ht->table, i);
+        *(size_t*)slot = _misc_htable_hash(ht, slot + ht->key_offset);
+        _misc_store_move_in(ht, &new_table, slot);
+    }
+
+    _misc_store_free(&ht->table);
+    ht->table = new_table;
+
+    ht->counters.rehash_count++;
+    ht->counters.rehash_ns += _misc_now_ns() - start;
+
+    return 1;
+}
+
+void misc_htable_destroy(misc_htable ht)
+{
+    if (ht == NULL) return;
+
+    if (ht->key_kind == HTABLE_KEY_OWNED_STR)
+    {
+        _misc_store_free_keys(ht, &ht->table);
+        _misc_store_free_keys(ht, &ht->old);
+    }
+
+    _misc_store_free(&ht->table);
+    _misc_store_free(&ht->old);
+    free(ht);
+}
+
+void misc_htable_clear(misc_htable ht)
+{
+    if (ht == NULL) return;
+
+    if (ht->key_kind == HTABLE_KEY_OWNED_STR)
+    {
+        _misc_store_free_keys(ht, &ht->table);
+        _misc_store_free_keys(ht, &ht->old);
+    }
+
+    _misc_store_free(&ht->old);
+    ht->old.size = 0;
+
+    memset(ht->table.ctrl, CTRL_EMPTY, ht->table.capacity + HTABLE_GROUP_MAX);
+    ht->table.size = 0;
+    ht->table.tombstones = 0;
+}
+
+size_t misc_htable_hash(const misc_htable ht, const void *key)
+{
+    if (ht == NULL || key == NULL) return 0;
+
+    misc_htable_strkey tmp;
+    return _misc_htable_hash(ht, _misc_htable_key(ht, key, &tmp));
+}
+
+size_t misc_htable_size(const misc_htable ht)
+{
+    if (ht == NULL) return 0;
+    return ht->table.size + ht->old.size;
+}
+
+int misc_htable_contains(const misc_htable ht, const void *key)
+{
+    if (ht == NULL || key == NULL) return 0;
+
+    if (ht->old.ctrl != NULL) _misc_htable_migrate(ht, HTABLE_REHASH_STEP);
+
+    size_t idx;
+    int found = _misc_htable_locate(ht, key, &idx) != NULL;
+
+    HTABLE_STAT_ADD(ht, lookups, 1);
+    HTABLE_STAT_ADD(ht, hits, found);
+
+    return found;
+}
+
+void* misc_htable_get(const misc_htable ht, const void *key)
+{
+    if (ht == NULL || key == NULL) return NULL;
+
+    if (ht->old.ctrl != NULL) _misc_htable_migrate(ht, HTABLE_REHASH_STEP);
+
+    size_t idx;
+    misc_htable_store *st = _misc_htable_locate(ht, key, &idx);
+
+    HTABLE_STAT_ADD(ht, lookups, 1);
+    HTABLE_STAT_ADD(ht, hits, st != NULL);
+
+    if (st == NULL) return NULL;
+
+    return SLOT_VALUE(ht, st, idx);
+}
+
+/*
+ * Rebuilds the table into a single store of new_capacity, in one go.
+ */
+static int _misc_htable_resize(misc_htable ht, size_t new_capacity)
+{
+    uint64_t start = _misc_now_ns();
+
+    misc_htable_store new_table;
+    if (!_misc_store_alloc(&new_table, new_capacity, ht->slot_size)) return 0;
+
+    for (size_t i = 0; i < ht->table.capacity; i++)
+    {
+        if (!CTRL_ISFULL(ht->table.ctrl[i])) continue;
+
+        _misc_store_move_in(ht, &new_table, SLOT(ht, &ht->table, i));
+    }
+
+    /*
+     * The entries a pending migration has not moved yet go straight to the
+     * new store too: draining them into the current one first could overfill
+     * it, e.g. after a shrink left a large, sparse old store behind.
+     */
+    if (ht->old.ctrl != NULL)
+    {
+        for (size_t i = ht->migrate_idx; i < ht->old.capacity; i++)
+        {
+            if (!CTRL_ISFULL(ht->old.ctrl[i])) continue;
+
+            _misc_store_move_in(ht, &new_table, SLOT(ht, &ht->old, i));
+        }
+
+        _misc_store_free(&ht->old);
+        ht->old.capacity = 0;
+        ht->old.size = 0;
+        ht->old.tombstones = 0;
+    }
+
+    _misc_store_free(&ht->table);
+    ht->table = new_table;
+
+    ht->counters.rehash_count++;
+    ht->counters.rehash_ns += _misc_now_ns() - start;
+
+    return 1;
+}
+
+size_t misc_htable_get_batch(const misc_htable ht, const void *keys, size_t n, void **out_values)
+{
+    if (ht == NULL || keys == NULL || out_values == NULL) return 0;
+
+    /* A single migration step upfront keeps all returned pointers valid together */
+    if (ht->old.ctrl != NULL) _misc_htable_migrate(ht, HTABLE_REHASH_STEP);
+
+    const misc_htable_store *st = &ht->table;
+    const uint8_t *key = (const uint8_t*)keys;
+    const void *batch_keys[HTABLE_BATCH];
+    size_t hashes[HTABLE_BATCH];
+    misc_htable_strkey tmp[HTABLE_BATCH];
+    size_t found = 0;
+
+    for (size_t base = 0; base < n; base += HTABLE_BATCH)
+    {
+        size_t count = n - base < HTABLE_BATCH ? n - base : HTABLE_BATCH;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            batch_keys[i] = _misc_htable_key(ht, key + i * ht->input_key_size, &tmp[i]);
+            hashes[i] = _misc_htable_hash(ht, batch_keys[i]);
+
+            size_t home = hashes[i] & st->mask;
+            HTABLE_PREFETCH(st->ctrl + home);
+            HTABLE_PREFETCH(SLOT(ht, st, home));
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const void *k = batch_keys[i];
+            void *value = NULL;
+
+            size_t idx = _misc_store_find(ht, st, k, hashes[i]);
+            if (idx != st->capacity)
+            {
+                value = SLOT_VALUE(ht, st, idx);
+            }
+            else if (ht->old.ctrl != NULL)
+            {
+                idx = _misc_store_find(ht, &ht->old, k, hashes[i]);
+                if (idx != ht->old.capacity) value = SLOT_VALUE(ht, &ht->old, idx);
+            }
+
+            out_values[base + i] = value;
+            if (value != NULL) found++;
+        }
+
+        key += count * ht->input_key_size;
+    }
+
+    HTABLE_STAT_ADD(ht, lookups, n);
+    HTABLE_STAT_ADD(ht, hits, found);
+
+    return found;
+}
+
+/*
+ * Makes the current store big enough for one more insertion. The table is
+ * rebuilt into a store of new_capacity, either in one go or, in incremental
+ * mode, by setting the current store aside as the old one and migrating its
+ * entries over the following operations.
+ */
+static int _misc_htable_rehash(misc_htable ht, size_t new_capacity)
+{
+    /* A rehash started during a migration merges both stores in one go */
+    if (!(ht->flags & MISC_HTABLE_INCREMENTAL) || ht->old.ctrl != NULL)
+    {
+        return _misc_htable_resize(ht, new_capacity);
+    }
+
+    misc_htable_store new_table;
+    if (!_misc_store_alloc(&new_table, new_capacity, ht->slot_size)) return 0;
+
+    ht->old = ht->table;
+    ht->table = new_table;
+    ht->migrate_idx = 0;
+
+    /* The entries are moved, and timed, by the following migration steps */
+    ht->counters.rehash_count++;
+
+    return 1;
+}
+
+/*
+ * Smallest capacity that holds n entries without exceeding the maximum load
+ * factor, or 0 if no power of two that fits a size_t is large enough.
+ */
+static size_t _misc_htable_capacity_for(const misc_htable ht, size_t n)
+{
+    size_t capacity = HTABLE_MIN_CAPACITY;
+    while ((double)capacity * ht->max_load < (double)n)
+    {
+        if (capacity == HTABLE_MAX_CAPACITY) return 0;
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+int misc_htable_reserve(misc_htable ht, size_t n)
+{
+    if (ht == NULL) return 0;
+
+    size_t capacity = _misc_htable_capacity_for(ht, n);
+    if (capacity == 0) return 0;
+    if (capacity < ht->table.capacity) capacity = ht->table.capacity;
+
+    /*
+     * Inserting up to n entries must not trigger a rehash, so the tombstones
+     * are dropped too if they would push the load over the limit.
+     */
+    if (capacity > ht->table.capacity || ht->old.ctrl != NULL ||
+        (double)(ht->table.tombstones + n) > (double)ht->table.capacity * ht->max_load)
+    {
+        return _misc_htable_resize(ht, capacity);
+    }
+
+    return 1;
+}
+
+/*
+ * Finds the slot holding key, or claims a new one for it (storing the key but
+ * leaving the value uninitialized). Returns a pointer to the value, or NULL
+ * on allocation failure; *inserted tells whether the slot is new.
+ */
+static void* _misc_htable_acquire(misc_htable ht, const void *key, int *inserted)
+{
+    if (ht->old.ctrl != NULL) _misc_htable_migrate(ht, HTABLE_REHASH_STEP);
+
+    misc_htable_strkey tmp;
+    key = _misc_htable_key(ht, key, &tmp);
+
+    int found;
+    size_t hash = _misc_htable_hash(ht, key);
+    misc_htable_store *st = &ht->table;
+    size_t idx = _misc_store_find_insert(ht, st, key, hash, &found);
+
+    *inserted = 0;
+
+    if (found) return SLOT_VALUE(ht, st, idx);
+
+    if (ht->old.ctrl != NULL)
+    {
+        size_t old_idx = _misc_store_find(ht, &ht->old, key, hash);
+        if (old_idx != ht->old.capacity) return SLOT_VALUE(ht, &ht->old, old_idx);
+    }
+
+    /*
+     * Tombstones count towards the load since they lengthen probes just like
+     * live entries. If the table is crowded mostly by tombstones, rebuilding
+     * at the same capacity is enough to get rid of them. Entries still in the
+     * old store count too: migration moves them into this one.
+     */
+    if (st->ctrl[idx] == CTRL_EMPTY &&
+        (double)(st->size + ht->old.size + st->tombstones + 1) > (double)st->capacity * ht->max_load)
+    {
+        size_t size = st->size + ht->old.size;
+        size_t new_capacity = st->capacity;
+        if ((double)(size + 1) > (double)st->capacity * ht->max_load / 2)
+        {
+            if (new_capacity == HTABLE_MAX_CAPACITY) return NULL;
+            new_capacity *= 2;
+        }
+
+        if (!_misc_htable_rehash(ht, new_capacity))
+        {
+            return NULL;
+        }
+
+        idx = _misc_store_find_insert(ht, st, key, hash, &found);
+    }
+
+    if (ht->key_kind == HTABLE_KEY_OWNED_STR)
+    {
+        char *copy = (char*)malloc(tmp.len + 1);
+        if (copy == NULL) return NULL;
+
+        memcpy(copy, tmp.str, tmp.len + 1);
+        tmp.str = copy;
+    }
+
+    if (st->ctrl[idx] == CTRL_DELETED) st->tombstones--;
+
+    _misc_set_ctrl(st->ctrl, st->capacity, idx, _misc_hash_tag(hash));
+    SLOT_HASH(ht, st, idx) = hash;
+    memcpy(SLOT_KEY(ht, st, idx), key, ht->key_size);
+
+    st->size++;
+    *inserted = 1;
+    HTABLE_STAT_ADD(ht, inserts, 1);
+    return SLOT_VALUE(ht, st, idx);
+}
+
+int misc_htable_put(misc_htable ht, const void *key, const void *value)
+{
+    if (ht == NULL || key == NULL) return 0;
+    if (value == NULL && ht->value_size != 0) return 0;
+
+    int inserted;
+    void *slot = _misc_htable_acquire(ht, key, &inserted);
+    if (slot == NULL) return 0;
+
+    if (ht->value_size != 0) memcpy(slot, value, ht->value_size);
+    return 1;
+}
+
+void* misc_htable_get_or_insert(misc_htable ht, const void *key, int *inserted)
+{
+    if (ht == NULL || key == NULL) return NULL;
+
+    int is_new;
+    void *slot = _misc_htable_acquire(ht, key, &is_new);
+    if (slot == NULL) return NULL;
+
+    if (is_new) memset(slot, 0, ht->value_size);
+    if (inserted != NULL) *inserted = is_new;
+
+    return slot;
+}
+
+void* misc_htable_emplace(misc_htable ht, const void *key, int *inserted)
+{
+    if (ht == NULL || key == NULL) return NULL;
+
+    int is_new;
+    void *slot = _misc_htable_acquire(ht, key, &is_new);
+    if (slot == NULL) return NULL;
+
+    if (inserted != NULL) *inserted = is_new;
+
+    return slot;
+}
+
+int misc_htable_remove(misc_htable ht, const void *key)
+{
+    if (ht == NULL || key == NULL) return 0;
+
+    if (ht->old.ctrl != NULL) _misc_htable_migrate(ht, HTABLE_REHASH_STEP);
+
+    size_t idx;
+    misc_htable_store *st = _misc_htable_locate(ht, key, &idx);
+    if (st == NULL) return 0;
+
+    if (ht->key_kind == HTABLE_KEY_OWNED_STR)
+    {
+        free((void*)((misc_htable_strkey*)SLOT_KEY(ht, st, idx))->str);
+    }
+
+    _misc_store_erase(st, idx);
+    HTABLE_STAT_ADD(ht, removes, 1);
+
+    /* Shrinking is best effort: on allocation failure the table stays as is */
+    if ((ht->flags & MISC_HTABLE_SHRINK) && ht->old.ctrl == NULL &&
+        ht->table.capacity > HTABLE_MIN_CAPACITY &&
+        (double)ht->table.size < (double)ht->table.capacity * ht->max_load * HTABLE_LOW_WATER)
+    {
+        size_t capacity = _misc_htable_capacity_for(ht, ht->table.size * 2);
+        if (capacity != 0) _misc_htable_rehash(ht, capacity);
+    }
+
+    return 1;
+}
+
+int misc_htable_compact(misc_htable ht)
+{
+    if (ht == NULL) return 0;
+
+    size_t capacity = _misc_htable_capacity_for(ht, misc_htable_size(ht));
+    if (capacity == 0) return 0;
+    if (capacity == ht->table.capacity && ht->old.ctrl == NULL && ht->table.tombstones == 0)
+    {
+        return 1;
+    }
+
+    return _misc_htable_resize(ht, capacity);
+}
+
+int misc_htable_put_many(misc_htable ht, const void *keys, const void *values, size_t n)
+{
+    if (ht == NULL || keys == NULL || values == NULL) return 0;
+
+    if (!misc_htable_reserve(ht, misc_htable_size(ht) + n)) return 0;
+
+    const uint8_t *key = (const uint8_t*)keys;
+    const uint8_t *value = (const uint8_t*)values;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!misc_htable_put(ht, key, value)) return 0;
+
+        key += ht->input_key_size;
+        value += ht->value_size;
+    }
+
+    return 1;
+}
+
+void misc_htable_iter_begin(misc_htable ht, misc_htable_iter *it)
+{
+    if (it == NULL) return;
+
+    it->ht = ht;
+    it->slots = NULL;
+    it->idx = 0;
+
+    if (ht == NULL) return;
+
+    /* The cursor walks a single store, so a pending migration is finished first */
+    if (ht->old.ctrl != NULL) _misc_htable_migrate(ht, ht->old.capacity);
+
+    it->slots = ht->table.slots;
+}
+
+int misc_htable_iter_next(misc_htable_iter *it, void **key, void **value)
+{
+    if (it == NULL || it->ht == NULL) return 0;
+
+    misc_htable ht = it->ht;
+    misc_htable_store *st = &ht->table;
+
+    /* The table was rebuilt since the cursor was started */
+    if (st->slots != it->slots) return 0;
+
+    while (it->idx < st->capacity)
+    {
+        size_t i = it->idx++;
+        if (!CTRL_ISFULL(st->ctrl[i])) continue;
+
+        if (key != NULL) *key = SLOT_KEY(ht, st, i);
+        if (value != NULL) *value = SLOT_VALUE(ht, st, i);
+        return 1;
+    }
+
+    return 0;
+}
+
+static void _misc_store_visit(const misc_htable ht, const misc_htable_store *st,
+                              size_t from, size_t to,
+                              misc_htable_visit_fn fn, void *ctx)
+{
+    for (size_t i = from; i < to; i++)
+    {
+        if (CTRL_ISFULL(st->ctrl[i])) fn(SLOT_KEY(ht, st, i), SLOT_VALUE(ht, st, i), ctx);
+    }
+}
+
+void misc_htable_foreach(const misc_htable ht, misc_htable_visit_fn fn, void *ctx)
+{
+    if (ht == NULL || fn == NULL) return;
+
+    _misc_store_visit(ht, &ht->table, 0, ht->table.capacity, fn, ctx);
+    if (ht->old.ctrl != NULL) _misc_store_visit(ht, &ht->old, 0, ht->old.capacity, fn, ctx);
+}
+
+typedef struct misc_htable_visit_job
+{
+
+    misc_htable ht;
+    size_t part;
+    size_t nparts;
+    misc_htable_visit_fn fn;
+    void *ctx;
+
+} misc_htable_visit_job;
+
+/*
+ * Visits the part-th of nparts equal slices of the slot range of each store.
+ */
+static void* _misc_htable_visit_part(void *arg)
+{
+    misc_htable_visit_job *job = (misc_htable_visit_job*)arg;
+    misc_htable ht = job->ht;
+
+    const misc_htable_store *stores[2] = { &ht->table, &ht->old };
+    for (int s = 0; s < 2; s++)
+    {
+        if (stores[s]->ctrl == NULL) continue;
+
+        size_t capacity = stores[s]->capacity;
+        size_t from = capacity / job->nparts * job->part;
+        size_t to = job->part + 1 == job->nparts ? capacity : capacity / job->nparts * (job->part + 1);
+        _misc_store_visit(ht, stores[s], from, to, job->fn, job->ctx);
+    }
+
+    return NULL;
+}
+
+void misc_htable_foreach_parallel(const misc_htable ht, misc_htable_visit_fn fn, void *ctx, size_t nthreads)
+{
+    if (ht == NULL || fn == NULL) return;
+    if (nthreads <= 1 || nthreads > ht->table.capacity)
+    {
+        misc_htable_foreach(ht, fn, ctx);
+        return;
+    }
+
+    misc_htable_visit_job *jobs = (misc_htable_visit_job*)malloc(nthreads * sizeof(misc_htable_visit_job));
+    pthread_t *threads = (pthread_t*)malloc(nthreads * sizeof(pthread_t));
+    int *started = (int*)calloc(nthreads, sizeof(int));
+    if (jobs == NULL || threads == NULL || started == NULL)
+    {
+        free(jobs);
+        free(threads);
+        free(started);
+        misc_htable_foreach(ht, fn, ctx);
+        return;
+    }
+
+    /*
+     * The calling thread takes the last slice itself; slices whose thread
+     * could not be started are also visited here.
+     */
+    for (size_t i = 0; i < nthreads; i++)
+    {
+        jobs[i].ht = ht;
+        jobs[i].part = i;
+        jobs[i].nparts = nthreads;
+        jobs[i].fn = fn;
+        jobs[i].ctx = ctx;
+
+        if (i + 1 < nthreads)
+        {
+            started[i] = pthread_create(&threads[i], NULL, _misc_htable_visit_part, &jobs[i]) == 0;
+        }
+    }
+
+    for (size_t i = 0; i < nthreads; i++)
+    {
+        if (!started[i]) _misc_htable_visit_part(&jobs[i]);
+    }
+
+    for (size_t i = 0; i + 1 < nthreads; i++)
+    {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+
+    free(jobs);
+    free(threads);
+    free(started);
+}
+
+static void _misc_store_stats(const misc_htable ht, const misc_htable_store *st,
+                              misc_htable_stats_info *out, size_t *probe_sum)
+{
+    for (size_t i = 0; i < st->capacity; i++)
+    {
+        if (!CTRL_ISFULL(st->ctrl[i])) continue;
+
+        size_t home = SLOT_HASH(ht, st, i) & st->mask;
+        size_t probe = ((i - home) & st->mask) + 1;
+
+        *probe_sum += probe;
+        if (probe > out->max_probe) out->max_probe = probe;
+
+        size_t bucket = probe - 1;
+        if (bucket >= MISC_HTABLE_STATS_BUCKETS) bucket = MISC_HTABLE_STATS_BUCKETS - 1;
+        out->probe_histogram[bucket]++;
+    }
+}
+
+int misc_htable_stats(const misc_htable ht, misc_htable_stats_info *out)
+{
+    if (ht == NULL || out == NULL) return 0;
+
+    memset(out, 0, sizeof(*out));
+
+    const misc_htable_store *st = &ht->table;
+    out->capacity = st->capacity;
+    out->size = misc_htable_size(ht);
+    out->tombstones = st->tombstones;
+    out->load_factor = (double)(out->size + st->tombstones) / (double)st->capacity;
+
+    size_t probe_sum = 0;
+    _misc_store_stats(ht, st, out, &probe_sum);
+    if (ht->old.ctrl != NULL) _misc_store_stats(ht, &ht->old, out, &probe_sum);
+    if (out->size > 0) out->mean_probe = (double)probe_sum / (double)out->size;
+
+    /*
+     * Clusters are measured on the current store, starting right after an
+     * empty slot so that a run wrapping around the end is counted once.
+     */
+    size_t start = 0;
+    while (start < st->capacity && st->ctrl[start] != CTRL_EMPTY) start++;
+
+    size_t run = 0;
+    for (size_t n = 1; n <= st->capacity; n++)
+    {
+        size_t i = (start + n) & st->mask;
+        if (st->ctrl[i] == CTRL_EMPTY) run = 0;
+        else if (++run > out->max_cluster) out->max_cluster = run;
+    }
+
+    out->rehash_count = ht->counters.rehash_count;
+    out->rehash_seconds = (double)ht->counters.rehash_ns * 1e-9;
+    out->lookups = ht->counters.lookups;
+    out->hits = ht->counters.hits;
+    out->inserts = ht->counters.inserts;
+    out->removes = ht->counters.removes;
+
+    return 1;
+}
+
+/*
+ * Hash and key of an entry in the frozen format. The hash depends only on the
+ * key, never on the table's seed or finalizer, so that the reader can compute
+ * it without the source table.
+ */
+/*
+ * Writes the file under a temporary name in the same directory, syncs it and
+ * renames it over path. Readers that mapped the previous file keep its inode,
+ * so replacing a table that worker processes are using never changes the
+ * pages under them.
+ */
+static int _misc_freeze_write(const char *path, const uint8_t *buf, size_t size)
+{
+    static const char suffix[] = ".XXXXXX";
+
+    size_t len = strlen(path);
+    char *tmp_path = (char*)malloc(len + sizeof(suffix));
+    if (tmp_path == NULL) return 0;
+
+    memcpy(tmp_path, path, len);
+    memcpy(tmp_path + len, suffix, sizeof(suffix));
+
+    int fd = mkstemp(tmp_path);
+    if (fd < 0)
+    {
+        free(tmp_path);
+        return 0;
+    }
+
+    /* mkstemp creates the file private to its owner; frozen tables are meant to be shared */
+    int ok = fchmod(fd, 0644) == 0;
+
+    FILE *f = fdopen(fd, "wb");
+    if (f == NULL) close(fd);
+
+    ok = ok && f != NULL && fwrite(buf, 1, size, f) == size;
+    ok = ok && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    if (f != NULL && fclose(f) != 0) ok = 0;
+
+    ok = ok && rename(tmp_path, path) == 0;
+    if (!ok) unlink(tmp_path);
+
+    free(tmp_path);
+    return ok;
+}
+
+static int _misc_freeze_kind(const misc_htable ht)
+{
+    switch (ht->key_kind)
+    {
+        case HTABLE_KEY_STR:
+        case HTABLE_KEY_OWNED_STR:
+            return FHTABLE_KEY_STR;
+        case HTABLE_KEY_INT:
+            return FHTABLE_KEY_INT;
+        case HTABLE_KEY_U64:
+            return FHTABLE_KEY_U64;
+        case HTABLE_KEY_PTR:
+            /* Addresses mean nothing to another process */
+            return -1;
+        default:
+            return FHTABLE_KEY_BYTES;
+    }
+}
+
+static const char* _misc_freeze_str(const misc_htable ht, const void *key, size_t *len)
+{
+    if (ht->key_kind == HTABLE_KEY_OWNED_STR)
+    {
+        const misc_htable_strkey *k = (const misc_htable_strkey*)key;
+        *len = k->len;
+        return k->str;
+    }
+
+    const char *str = *(const char**)key;
+    *len = strlen(str);
+    return str;
+}
+
+static void _misc_freeze_store(const misc_htable ht, const misc_htable_store *st,
+                               int kind, uint8_t *buf, const misc_fhtable_header *hdr,
+                               size_t *blob_pos)
+{
+    uint8_t *ctrl = buf + hdr->ctrl_offset;
+    size_t mask = hdr->capacity - 1;
+
+    for (size_t i = 0; i < st->capacity; i++)
+    {
+        if (!CTRL_ISFULL(st->ctrl[i])) continue;
+
+        const void *key = SLOT_KEY(ht, st, i);
+        misc_fhtable_strkey strkey;
+        uint64_t hash;
+
+        if (kind == FHTABLE_KEY_STR)
+        {
+            size_t len;
+            const char *str = _misc_freeze_str(ht, key, &len);
+
+            memcpy(buf + hdr->blob_offset + *blob_pos, str, len + 1);
+            strkey.offset = *blob_pos;
+            strkey.len = len;
+            *blob_pos += len + 1;
+
+            hash = _misc_wyhash(str, len, 0);
+            key = &strkey;
+        }
+        else if (kind == FHTABLE_KEY_INT)
+        {
+            hash = _misc_splitmix_fn((size_t)(*(const int*)key));
+        }
+        else if (kind == FHTABLE_KEY_U64)
+        {
+            hash = _misc_splitmix_fn((size_t)_misc_load_u64(key));
+        }
+        else
+        {
+            hash = _misc_splitmix_fn(ht->hash_func(key));
+        }
+
+        size_t idx = hash & mask;
+        while (ctrl[idx] != FHTABLE_CTRL_EMPTY)
+        {
+            idx = (idx + 1) & mask;
+        }
+
+        uint8_t *slot = buf + hdr->slots_offset + idx * hdr->slot_size;
+        ctrl[idx] = FHTABLE_TAG(hash);
+        memcpy(slot, &hash, sizeof(hash));
+        memcpy(slot + hdr->key_offset, key, hdr->key_size);
+        memcpy(slot + hdr->value_offset, SLOT_VALUE(ht, st, i), hdr->value_size);
+    }
+}
+
+int misc_htable_freeze(const misc_htable ht, const char *path)
+{
+    if (ht == NULL || path == NULL) return 0;
+
+    int kind = _misc_freeze_kind(ht);
+    if (kind < 0) return 0;
+
+    misc_fhtable_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, FHTABLE_MAGIC, sizeof(hdr.magic));
+    hdr.version = FHTABLE_VERSION;
+    hdr.key_kind = (uint32_t)kind;
+    hdr.byte_order = FHTABLE_BYTE_ORDER;
+
+    hdr.count = misc_htable_size(ht);
+    hdr.capacity = _misc_htable_capacity_for(ht, hdr.count);
+    if (hdr.capacity == 0) return 0;
+
+    size_t key_size = kind == FHTABLE_KEY_STR ? sizeof(misc_fhtable_strkey) : ht->key_size;
+    size_t key_align = _misc_size_align(key_size);
+    size_t value_align = ht->value_size == 0 ? 1 : _misc_size_align(ht->value_size);
+    size_t slot_align = key_align > value_align ? key_align : value_align;
+    if (slot_align < sizeof(uint64_t)) slot_align = sizeof(uint64_t);
+
+    hdr.key_size = key_size;
+    hdr.value_size = ht->value_size;
+    hdr.key_offset = _misc_round_up(sizeof(uint64_t), key_align);
+    hdr.value_offset = _misc_round_up(hdr.key_offset + key_size, value_align);
+    hdr.slot_size = _misc_round_up(hdr.value_offset + ht->value_size, slot_align);
+
+    /* Sum of the string lengths, each with its NUL */
+    if (kind == FHTABLE_KEY_STR)
+    {
+        const misc_htable_store *stores[2] = { &ht->table, &ht->old };
+        for (int s = 0; s < 2; s++)
+        {
+            const misc_htable_store *st = stores[s];
+            if (st->ctrl == NULL) continue;
+
+            for (size_t i = 0; i < st->capacity; i++)
+            {
+                if (!CTRL_ISFULL(st->ctrl[i])) continue;
+
+                size_t len;
+                _misc_freeze_str(ht, SLOT_KEY(ht, st, i), &len);
+                hdr.blob_size += len + 1;
+            }
+        }
+    }
+
+    hdr.slots_offset = _misc_round_up(sizeof(hdr), FHTABLE_ALIGN);
+    hdr.ctrl_offset = hdr.slots_offset + hdr.capacity * hdr.slot_size;
+    hdr.blob_offset = hdr.ctrl_offset + hdr.capacity;
+    hdr.file_size = hdr.blob_offset + hdr.blob_size;
+
+    uint8_t *buf = (uint8_t*)calloc(1, hdr.file_size);
+    if (buf == NULL) return 0;
+
+    memcpy(buf, &hdr, sizeof(hdr));
+    memset(buf + hdr.ctrl_offset, FHTABLE_CTRL_EMPTY, hdr.capacity);
+
+    size_t blob_pos = 0;
+    _misc_freeze_store(ht, &ht->table, kind, buf, &hdr, &blob_pos);
+    if (ht->old.ctrl != NULL) _misc_freeze_store(ht, &ht->old, kind, buf, &hdr, &blob_pos);
+
+    int ok = _misc_freeze_write(path, buf, hdr.file_size);
+
+    free(buf);
+    return ok;
 }
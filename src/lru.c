@@ -0,0 +1,731 @@
+#include "misc/lru.h"
+#include "misc/htable.h"
+#include "shards.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define LRU_NIL ((size_t)-1)
+#define LRU_MAX_ALIGN 16
+
+/* Low bits of the flags are passed on to the index hash table */
+#define LRU_HTABLE_FLAGS(flags) ((flags) & (MISC_LRU_CLOCK - 1))
+
+/*
+ * Each node starts with this header, followed by the key and the value. Nodes
+ * are linked by index, most recently used (or, with CLOCK, most recently
+ * inserted) first; unused nodes are chained through next.
+ */
+typedef struct misc_lru_node
+{
+
+    size_t prev;
+    size_t next;
+    size_t charge;
+    int referenced;
+
+} misc_lru_node;
+
+struct misc_generic_lru
+{
+
+    misc_htable index;
+
+    uint8_t *nodes;
+    size_t node_size;
+    size_t key_offset;
+    size_t value_offset;
+
+    size_t key_size;
+    size_t value_size;
+    int owns_str;
+    int flags;
+
+    size_t capacity;
+    size_t count;
+    size_t max_bytes;
+    size_t bytes;
+
+    size_t head;
+    size_t tail;
+    size_t free_head;
+
+    misc_lru_evict_fn on_evict;
+    void *evict_ctx;
+
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+
+};
+
+#define NODE(lru, i)       ((misc_lru_node*)((lru)->nodes + (i) * (lru)->node_size))
+#define NODE_KEY(lru, i)   ((lru)->nodes + (i) * (lru)->node_size + (lru)->key_offset)
+#define NODE_VALUE(lru, i) ((lru)->nodes + (i) * (lru)->node_size + (lru)->value_offset)
+
+
+static size_t _misc_lru_align(size_t size)
+{
+    size_t align = size & (~size + 1);
+    return align > LRU_MAX_ALIGN ? LRU_MAX_ALIGN : align;
+}
+
+static size_t _misc_lru_round_up(size_t n, size_t align)
+{
+    return (n + align - 1) & ~(align - 1);
+}
+
+static void _misc_lru_unlink(misc_lru lru, size_t i)
+{
+    misc_lru_node *node = NODE(lru, i);
+
+    if (node->prev != LRU_NIL) NODE(lru, node->prev)->next = node->next;
+    else lru->head = node->next;
+
+    if (node->next != LRU_NIL) NODE(lru, node->next)->prev = node->prev;
+    else lru->tail = node->prev;
+}
+
+static void _misc_lru_push_front(misc_lru lru, size_t i)
+{
+    misc_lru_node *node = NODE(lru, i);
+
+    node->prev = LRU_NIL;
+    node->next = lru->head;
+
+    if (lru->head != LRU_NIL) NODE(lru, lru->head)->prev = i;
+    else lru->tail = i;
+
+    lru->head = i;
+}
+
+/*
+ * Unlinks node i, drops its key from the index and returns the node to the
+ * free list.
+ */
+static void _misc_lru_release(misc_lru lru, size_t i)
+{
+    misc_htable_remove(lru->index, NODE_KEY(lru, i));
+    if (lru->owns_str) free(*(char**)NODE_KEY(lru, i));
+
+    _misc_lru_unlink(lru, i);
+    NODE(lru, i)->next = lru->free_head;
+    lru->free_head = i;
+
+    lru->count--;
+    lru->bytes -= NODE(lru, i)->charge;
+}
+
+/*
+ * Evicts the least recently used entry. With CLOCK, entries referenced since
+ * they last reached the tail get a second chance: their mark is cleared and
+ * they go back to the front.
+ */
+static void _misc_lru_evict(misc_lru lru)
+{
+    size_t victim = lru->tail;
+
+    if (lru->flags & MISC_LRU_CLOCK)
+    {
+        while (NODE(lru, victim)->referenced)
+        {
+            NODE(lru, victim)->referenced = 0;
+            _misc_lru_unlink(lru, victim);
+            _misc_lru_push_front(lru, victim);
+            victim = lru->tail;
+        }
+    }
+
+    if (lru->on_evict != NULL) lru->on_evict(NODE_KEY(lru, victim), NODE_VALUE(lru, victim), lru->evict_ctx);
+
+    _misc_lru_release(lru, victim);
+    lru->evictions++;
+}
+
+static void _misc_lru_touch(misc_lru lru, size_t i)
+{
+    if (lru->flags & MISC_LRU_CLOCK)
+    {
+        NODE(lru, i)->referenced = 1;
+    }
+    else if (lru->head != i)
+    {
+        _misc_lru_unlink(lru, i);
+        _misc_lru_push_front(lru, i);
+    }
+}
+
+static void _misc_lru_reset(misc_lru lru)
+{
+    lru->head = LRU_NIL;
+    lru->tail = LRU_NIL;
+    lru->count = 0;
+    lru->bytes = 0;
+
+    lru->free_head = LRU_NIL;
+    for (size_t i = lru->capacity; i-- > 0;)
+    {
+        NODE(lru, i)->next = lru->free_head;
+        lru->free_head = i;
+    }
+}
+
+/*
+ * Completes a cache around its index table. The index maps each key to the
+ * position of its node, and is sized upfront so that it never rehashes.
+ */
+static misc_lru _misc_lru_init(misc_htable index, size_t value_size, size_t key_size,
+                               size_t capacity, int flags, int owns_str)
+{
+    if (index == NULL) return NULL;
+
+    misc_lru lru = (misc_lru)malloc(sizeof(struct misc_generic_lru));
+    if (lru == NULL)
+    {
+        misc_htable_destroy(index);
+        return NULL;
+    }
+
+    size_t key_align = _misc_lru_align(key_size);
+    size_t value_align = _misc_lru_align(value_size);
+    size_t node_align = key_align > value_align ? key_align : value_align;
+    if (node_align < _Alignof(misc_lru_node)) node_align = _Alignof(misc_lru_node);
+
+    lru->key_offset = _misc_lru_round_up(sizeof(misc_lru_node), key_align);
+    lru->value_offset = _misc_lru_round_up(lru->key_offset + key_size, value_align);
+    lru->node_size = _misc_lru_round_up(lru->value_offset + value_size, node_align);
+
+    lru->nodes = NULL;
+    if (capacity <= SIZE_MAX / lru->node_size && misc_htable_reserve(index, capacity))
+    {
+        lru->nodes = (uint8_t*)malloc(capacity * lru->node_size);
+    }
+
+    if (lru->nodes == NULL)
+    {
+        misc_htable_destroy(index);
+        free(lru);
+        return NULL;
+    }
+
+    lru->index = index;
+    lru->key_size = key_size;
+    lru->value_size = value_size;
+    lru->owns_str = owns_str;
+    lru->flags = flags;
+    lru->capacity = capacity;
+    lru->max_bytes = 0;
+    lru->on_evict = NULL;
+    lru->evict_ctx = NULL;
+    lru->hits = 0;
+    lru->misses = 0;
+    lru->evictions = 0;
+
+    _misc_lru_reset(lru);
+
+    return lru;
+}
+
+
+misc_lru misc_lru_create(size_t value_size, size_t key_size,
+                         misc_hash_fn hash_func,
+                         misc_key_cmp_fn key_cmp,
+                         size_t capacity,
+                         int flags)
+{
+    if (value_size == 0 || key_size == 0 || capacity == 0) return NULL;
+
+    misc_htable index = misc_htable_create(sizeof(size_t), key_size, hash_func, key_cmp, LRU_HTABLE_FLAGS(flags));
+    return _misc_lru_init(index, value_size, key_size, capacity, flags, 0);
+}
+
+misc_lru misc_lru_create_str(size_t value_size, size_t capacity, int flags)
+{
+    if (value_size == 0 || capacity == 0) return NULL;
+
+    /* The index borrows the copy of each string owned by its node */
+    misc_htable index = misc_htable_create_str(sizeof(size_t), LRU_HTABLE_FLAGS(flags));
+    return _misc_lru_init(index, value_size, sizeof(char*), capacity, flags, 1);
+}
+
+misc_lru misc_lru_create_int(size_t value_size, size_t capacity, int flags)
+{
+    if (value_size == 0 || capacity == 0) return NULL;
+
+    misc_htable index = misc_htable_create_int(sizeof(size_t), LRU_HTABLE_FLAGS(flags));
+    return _misc_lru_init(index, value_size, sizeof(int), capacity, flags, 0);
+}
+
+misc_lru misc_lru_create_u64(size_t value_size, size_t capacity, int flags)
+{
+    if (value_size == 0 || capacity == 0) return NULL;
+
+    misc_htable index = misc_htable_create_u64(sizeof(size_t), LRU_HTABLE_FLAGS(flags));
+    return _misc_lru_init(index, value_size, sizeof(uint64_t), capacity, flags, 0);
+}
+
+void misc_lru_clear(misc_lru lru)
+{
+    if (lru == NULL) return;
+
+    for (size_t i = lru->head; i != LRU_NIL; i = NODE(lru, i)->next)
+    {
+        if (lru->on_evict != NULL) lru->on_evict(NODE_KEY(lru, i), NODE_VALUE(lru, i), lru->evict_ctx);
+        if (lru->owns_str) free(*(char**)NODE_KEY(lru, i));
+    }
+
+    misc_htable_clear(lru->index);
+    _misc_lru_reset(lru);
+}
+
+void misc_lru_destroy(misc_lru lru)
+{
+    if (lru == NULL) return;
+
+    misc_lru_clear(lru);
+    misc_htable_destroy(lru->index);
+    free(lru->nodes);
+    free(lru);
+}
+
+void misc_lru_set_evict(misc_lru lru, misc_lru_evict_fn fn, void *ctx)
+{
+    if (lru == NULL) return;
+
+    lru->on_evict = fn;
+    lru->evict_ctx = ctx;
+}
+
+void misc_lru_set_max_bytes(misc_lru lru, size_t max_bytes)
+{
+    if (lru == NULL) return;
+
+    lru->max_bytes = max_bytes;
+    while (max_bytes != 0 && lru->bytes > max_bytes)
+    {
+        _misc_lru_evict(lru);
+    }
+}
+
+size_t misc_lru_size(const misc_lru lru)
+{
+    if (lru == NULL) return 0;
+
+    return lru->count;
+}
+
+size_t misc_lru_bytes(const misc_lru lru)
+{
+    if (lru == NULL) return 0;
+
+    return lru->bytes;
+}
+
+void* misc_lru_get(misc_lru lru, const void *key)
+{
+    if (lru == NULL || key == NULL) return NULL;
+
+    size_t *idx = (size_t*)misc_htable_get(lru->index, key);
+    if (idx == NULL)
+    {
+        lru->misses++;
+        return NULL;
+    }
+
+    lru->hits++;
+    _misc_lru_touch(lru, *idx);
+
+    return NODE_VALUE(lru, *idx);
+}
+
+int misc_lru_contains(const misc_lru lru, const void *key)
+{
+    if (lru == NULL || key == NULL) return 0;
+
+    return misc_htable_contains(lru->index, key);
+}
+
+int misc_lru_put_charged(misc_lru lru, const void *key, const void *value, size_t charge)
+{
+    if (lru == NULL || key == NULL || value == NULL) return 0;
+    if (lru->max_bytes != 0 && charge > lru->max_bytes) return 0;
+
+    size_t *found = (size_t*)misc_htable_get(lru->index, key);
+    if (found != NULL)
+    {
+        size_t i = *found;
+        memcpy(NODE_VALUE(lru, i), value, lru->value_size);
+        lru->bytes += charge - NODE(lru, i)->charge;
+        NODE(lru, i)->charge = charge;
+        _misc_lru_touch(lru, i);
+
+        /* Only other entries are evicted, since this one alone fits the budget */
+        while (lru->max_bytes != 0 && lru->bytes > lru->max_bytes)
+        {
+            if (lru->tail == i)
+            {
+                _misc_lru_unlink(lru, i);
+                _misc_lru_push_front(lru, i);
+            }
+            _misc_lru_evict(lru);
+        }
+
+        return 1;
+    }
+
+    while (lru->count == lru->capacity || (lru->max_bytes != 0 && lru->bytes + charge > lru->max_bytes))
+    {
+        _misc_lru_evict(lru);
+    }
+
+    size_t i = lru->free_head;
+    void *node_key = NODE_KEY(lru, i);
+
+    if (lru->owns_str)
+    {
+        const char *str = *(const char**)key;
+        size_t len = strlen(str);
+        char *copy = (char*)malloc(len + 1);
+        if (copy == NULL) return 0;
+
+        memcpy(copy, str, len + 1);
+        *(char**)node_key = copy;
+    }
+    else
+    {
+        memcpy(node_key, key, lru->key_size);
+    }
+
+    if (!misc_htable_put(lru->index, node_key, &i))
+    {
+        if (lru->owns_str) free(*(char**)node_key);
+        return 0;
+    }
+
+    lru->free_head = NODE(lru, i)->next;
+    memcpy(NODE_VALUE(lru, i), value, lru->value_size);
+    NODE(lru, i)->charge = charge;
+    NODE(lru, i)->referenced = 0;
+    _misc_lru_push_front(lru, i);
+
+    lru->count++;
+    lru->bytes += charge;
+
+    return 1;
+}
+
+int misc_lru_put(misc_lru lru, const void *key, const void *value)
+{
+    if (lru == NULL) return 0;
+
+    return misc_lru_put_charged(lru, key, value, lru->value_size);
+}
+
+int misc_lru_remove(misc_lru lru, const void *key, void *out)
+{
+    if (lru == NULL || key == NULL) return 0;
+
+    size_t *found = (size_t*)misc_htable_get(lru->index, key);
+    if (found == NULL) return 0;
+
+    size_t i = *found;
+    if (out != NULL) memcpy(out, NODE_VALUE(lru, i), lru->value_size);
+
+    _misc_lru_release(lru, i);
+    return 1;
+}
+
+size_t misc_lru_hits(const misc_lru lru)
+{
+    if (lru == NULL) return 0;
+
+    return lru->hits;
+}
+
+size_t misc_lru_misses(const misc_lru lru)
+{
+    if (lru == NULL) return 0;
+
+    return lru->misses;
+}
+
+size_t misc_lru_evictions(const misc_lru lru)
+{
+    if (lru == NULL) return 0;
+
+    return lru->evictions;
+}
+
+
+/*
+ * The lock comes first, on its own cache line(s): see shards.h. Even gets
+ * modify a shard (recency order, counters), so the lock is a plain mutex.
+ */
+typedef struct misc_clru_shard
+{
+
+    _Alignas(MISC_SHARD_CACHE_LINE) pthread_mutex_t lock;
+    misc_lru lru;
+
+} misc_clru_shard;
+
+struct misc_concurrent_lru
+{
+
+    misc_clru_shard *shards;
+    size_t nshards;
+    size_t value_size;
+
+};
+
+static misc_clru_shard* _misc_clru_shard(const misc_clru clru, const void *key)
+{
+    size_t hash = misc_htable_hash(clru->shards[0].lru->index, key);
+    return &clru->shards[_misc_shards_index(hash, clru->nshards)];
+}
+
+static int _misc_clru_lock_init(void *lock)
+{
+    return pthread_mutex_init((pthread_mutex_t*)lock, NULL) == 0;
+}
+
+static void _misc_clru_lock_destroy(void *lock)
+{
+    pthread_mutex_destroy((pthread_mutex_t*)lock);
+}
+
+static misc_clru _misc_clru_alloc(size_t value_size, size_t capacity, size_t nshards, int flags, size_t *shard_capacity)
+{
+    if (capacity == 0) return NULL;
+    if (flags & MISC_HTABLE_INCREMENTAL) return NULL;
+
+    misc_clru clru = (misc_clru)malloc(sizeof(struct misc_concurrent_lru));
+    if (clru == NULL) return NULL;
+
+    clru->value_size = value_size;
+    clru->shards = (misc_clru_shard*)_misc_shards_alloc(nshards, sizeof(misc_clru_shard), &clru->nshards);
+    if (clru->shards == NULL)
+    {
+        free(clru);
+        return NULL;
+    }
+
+    *shard_capacity = (capacity + clru->nshards - 1) / clru->nshards;
+    return clru;
+}
+
+/*
+ * Called once every shard has been given its cache: sets up the locks, or
+ * tears everything down if any of the caches or locks could not be set up.
+ */
+static misc_clru _misc_clru_init(misc_clru clru)
+{
+    int ok = 1;
+    for (size_t i = 0; i < clru->nshards; i++)
+    {
+        if (clru->shards[i].lru == NULL) ok = 0;
+    }
+
+    if (ok)
+    {
+        ok = _misc_shards_init_locks(clru->shards, clru->nshards, sizeof(misc_clru_shard),
+                                     _misc_clru_lock_init, _misc_clru_lock_destroy);
+    }
+
+    if (!ok)
+    {
+        for (size_t i = 0; i < clru->nshards; i++)
+        {
+            misc_lru_destroy(clru->shards[i].lru);
+        }
+        free(clru->shards);
+        free(clru);
+        return NULL;
+    }
+
+    return clru;
+}
+
+misc_clru misc_clru_create(size_t value_size, size_t key_size,
+                           misc_hash_fn hash_func,
+                           misc_key_cmp_fn key_cmp,
+                           size_t capacity,
+                           size_t nshards,
+                           int flags)
+{
+    size_t shard_capacity;
+    misc_clru clru = _misc_clru_alloc(value_size, capacity, nshards, flags, &shard_capacity);
+    if (clru == NULL) return NULL;
+
+    for (size_t i = 0; i < clru->nshards; i++)
+    {
+        clru->shards[i].lru = misc_lru_create(value_size, key_size, hash_func, key_cmp, shard_capacity, flags);
+    }
+
+    return _misc_clru_init(clru);
+}
+
+misc_clru misc_clru_create_str(size_t value_size, size_t capacity, size_t nshards, int flags)
+{
+    size_t shard_capacity;
+    misc_clru clru = _misc_clru_alloc(value_size, capacity, nshards, flags, &shard_capacity);
+    if (clru == NULL) return NULL;
+
+    for (size_t i = 0; i < clru->nshards; i++)
+    {
+        clru->shards[i].lru = misc_lru_create_str(value_size, shard_capacity, flags);
+    }
+
+    return _misc_clru_init(clru);
+}
+
+misc_clru misc_clru_create_int(size_t value_size, size_t capacity, size_t nshards, int flags)
+{
+    size_t shard_capacity;
+    misc_clru clru = _misc_clru_alloc(value_size, capacity, nshards, flags, &shard_capacity);
+    if (clru == NULL) return NULL;
+
+    for (size_t i = 0; i < clru->nshards; i++)
+    {
+        clru->shards[i].lru = misc_lru_create_int(value_size, shard_capacity, flags);
+    }
+
+    return _misc_clru_init(clru);
+}
+
+misc_clru misc_clru_create_u64(size_t value_size, size_t capacity, size_t nshards, int flags)
+{
+    size_t shard_capacity;
+    misc_clru clru = _misc_clru_alloc(value_size, capacity, nshards, flags, &shard_capacity);
+    if (clru == NULL) return NULL;
+
+    for (size_t i = 0; i < clru->nshards; i++)
+    {
+        clru->shards[i].lru = misc_lru_create_u64(value_size, shard_capacity, flags);
+    }
+
+    return _misc_clru_init(clru);
+}
+
+void misc_clru_destroy(misc_clru clru)
+{
+    if (clru == NULL) return;
+
+    for (size_t i = 0; i < clru->nshards; i++)
+    {
+        pthread_mutex_destroy(&clru->shards[i].lock);
+        misc_lru_destroy(clru->shards[i].lru);
+    }
+
+    free(clru->shards);
+    free(clru);
+}
+
+void misc_clru_set_evict(misc_clru clru, misc_lru_evict_fn fn, void *ctx)
+{
+    if (clru == NULL) return;
+
+    for (size_t i = 0; i < clru->nshards; i++)
+    {
+        pthread_mutex_lock(&clru->shards[i].lock);
+        misc_lru_set_evict(clru->shards[i].lru, fn, ctx);
+        pthread_mutex_unlock(&clru->shards[i].lock);
+    }
+}
+
+void misc_clru_set_max_bytes(misc_clru clru, size_t max_bytes)
+{
+    if (clru == NULL) return;
+
+    size_t shard_bytes = (max_bytes + clru->nshards - 1) / clru->nshards;
+    for (size_t i = 0; i < clru->nshards; i++)
+    {
+        pthread_mutex_lock(&clru->shards[i].lock);
+        misc_lru_set_max_bytes(clru->shards[i].lru, shard_bytes);
+        pthread_mutex_unlock(&clru->shards[i].lock);
+    }
+}
+
+/* Sums one of the per-shard counters, each read under its shard's lock */
+static size_t _misc_clru_sum(const misc_clru clru, size_t (*counter)(const misc_lru))
+{
+    if (clru == NULL) return 0;
+
+    size_t sum = 0;
+    for (size_t i = 0; i < clru->nshards; i++)
+    {
+        pthread_mutex_lock(&clru->shards[i].lock);
+        sum += counter(clru->shards[i].lru);
+        pthread_mutex_unlock(&clru->shards[i].lock);
+    }
+
+    return sum;
+}
+
+size_t misc_clru_size(const misc_clru clru)
+{
+    return _misc_clru_sum(clru, misc_lru_size);
+}
+
+int misc_clru_get(misc_clru clru, const void *key, void *out)
+{
+    if (clru == NULL || key == NULL) return 0;
+
+    misc_clru_shard *shard = _misc_clru_shard(clru, key);
+
+    pthread_mutex_lock(&shard->lock);
+    void *value = misc_lru_get(shard->lru, key);
+    if (value != NULL && out != NULL) memcpy(out, value, clru->value_size);
+    pthread_mutex_unlock(&shard->lock);
+
+    return value != NULL;
+}
+
+int misc_clru_put_charged(misc_clru clru, const void *key, const void *value, size_t charge)
+{
+    if (clru == NULL || key == NULL || value == NULL) return 0;
+
+    misc_clru_shard *shard = _misc_clru_shard(clru, key);
+
+    pthread_mutex_lock(&shard->lock);
+    int ok = misc_lru_put_charged(shard->lru, key, value, charge);
+    pthread_mutex_unlock(&shard->lock);
+
+    return ok;
+}
+
+int misc_clru_put(misc_clru clru, const void *key, const void *value)
+{
+    if (clru == NULL) return 0;
+
+    return misc_clru_put_charged(clru, key, value, clru->value_size);
+}
+
+int misc_clru_remove(misc_clru clru, const void *key, void *out)
+{
+    if (clru == NULL || key == NULL) return 0;
+
+    misc_clru_shard *shard = _misc_clru_shard(clru, key);
+
+    pthread_mutex_lock(&shard->lock);
+    int removed = misc_lru_remove(shard->lru, key, out);
+    pthread_mutex_unlock(&shard->lock);
+
+    return removed;
+}
+
+size_t misc_clru_hits(const misc_clru clru)
+{
+    return _misc_clru_sum(clru, misc_lru_hits);
+}
+
+size_t misc_clru_misses(const misc_clru clru)
+{
+    return _misc_clru_sum(clru, misc_lru_misses);
+}
+
+size_t misc_clru_evictions(const misc_clru clru)
+{
+    return _misc_clru_sum(clru, misc_lru_evictions);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef MISC_SHARDS_H
+#define MISC_SHARDS_H
+
+/*
+ * Shard array setup shared by src/chtable.c and src/lru.c. Internal header:
+ * the public API is under include/misc.
+ *
+ * A shard is any struct whose first member is its lock, declared
+ * _Alignas(MISC_SHARD_CACHE_LINE) so that each shard sits on its own cache
+ * line(s) and taking one lock does not invalidate its neighbours in other
+ * cores' caches.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MISC_SHARD_CACHE_LINE 64
+
+
+/*
+ * Allocates a zeroed array of nshards rounded up to a power of two, storing
+ * the rounded count in *count. Returns NULL if nshards is 0, if the array
+ * size would overflow, or on allocation failure.
+ */
+static inline void* _misc_shards_alloc(size_t nshards, size_t shard_size, size_t *count)
+{
+    if (nshards == 0) return NULL;
+
+    /* Stops doubling before the array size can overflow */
+    size_t rounded = 1;
+    while (rounded < nshards)
+    {
+        if (rounded > SIZE_MAX / 2 / shard_size) return NULL;
+        rounded *= 2;
+    }
+
+    /* shard_size is a multiple of the alignment, as aligned_alloc requires of the total */
+    void *shards = aligned_alloc(MISC_SHARD_CACHE_LINE, rounded * shard_size);
+    if (shards == NULL) return NULL;
+
+    memset(shards, 0, rounded * shard_size);
+    *count = rounded;
+    return shards;
+}
+
+/*
+ * Initializes the lock at the start of every shard. If one fails, the locks
+ * already set up are destroyed and 0 is returned.
+ */
+static inline int _misc_shards_init_locks(void *shards, size_t count, size_t shard_size,
+                                          int (*init)(void *lock), void (*destroy)(void *lock))
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!init((uint8_t*)shards + i * shard_size))
+        {
+            while (i-- > 0) destroy((uint8_t*)shards + i * shard_size);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Shards are picked with the middle bits of the hash: the low bits choose the
+ * slot inside the shard's table and the top ones make up the slot tags.
+ * count must be a power of two.
+ */
+static inline size_t _misc_shards_index(size_t hash, size_t count)
+{
+    return (hash >> (sizeof(size_t) * 4)) & (count - 1);
+}
+
+#endif /* MISC_SHARDS_H */
@@ -0,0 +1,239 @@
+#include "misc/smallvec.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define SMALLVEC_GROWTH 2
+
+
+/*
+ * The inline buffer is a flexible array member, so the header and the first
+ * inline_capacity elements come from one allocation. data points either at
+ * it or at a heap buffer.
+ */
+struct misc_generic_smallvec
+{
+
+    void *data;
+
+    size_t length;
+    size_t capacity;
+    size_t elem_size;
+    size_t inline_capacity;
+
+    _Alignas(max_align_t) uint8_t inline_data[];
+
+};
+
+
+#define IS_INLINE(vec) ((vec)->data == (void*)(vec)->inline_data)
+
+/* Grows the capacity to at least min_cap, moving inline elements to the heap */
+static int _misc_smallvec_grow(misc_smallvec vec, size_t min_cap)
+{
+    if (min_cap <= vec->capacity) return 1;
+
+    size_t max_cap = SIZE_MAX / vec->elem_size;
+    if (min_cap > max_cap) return 0;
+
+    size_t new_cap = vec->capacity > max_cap / SMALLVEC_GROWTH ? max_cap : vec->capacity * SMALLVEC_GROWTH;
+    if (new_cap < min_cap) new_cap = min_cap;
+
+    void *new_data;
+    if (IS_INLINE(vec))
+    {
+        new_data = malloc(new_cap * vec->elem_size);
+        if (new_data == NULL) return 0;
+
+        memcpy(new_data, vec->inline_data, vec->length * vec->elem_size);
+    }
+    else
+    {
+        new_data = realloc(vec->data, new_cap * vec->elem_size);
+        if (new_data == NULL) return 0;
+    }
+
+    vec->data = new_data;
+    vec->capacity = new_cap;
+    return 1;
+}
+
+
+misc_smallvec misc_smallvec_create(size_t elem_size, size_t inline_capacity)
+{
+    if (elem_size == 0) return NULL;
+    if (inline_capacity > (SIZE_MAX - sizeof(struct misc_generic_smallvec)) / elem_size) return NULL;
+
+    misc_smallvec vec = (misc_smallvec) malloc(sizeof(struct misc_generic_smallvec) + inline_capacity * elem_size);
+    if (vec == NULL) return NULL;
+
+    vec->data = vec->inline_data;
+    vec->length = 0;
+    vec->capacity = inline_capacity;
+    vec->elem_size = elem_size;
+    vec->inline_capacity = inline_capacity;
+
+    return vec;
+}
+
+
+void misc_smallvec_destroy(misc_smallvec vec)
+{
+    if (vec == NULL) return;
+
+    if (!IS_INLINE(vec)) free(vec->data);
+    free((void*)vec);
+}
+
+
+void misc_smallvec_clear(misc_smallvec vec)
+{
+    if (vec != NULL) vec->length = 0;
+}
+
+
+size_t misc_smallvec_length(const misc_smallvec vec)
+{
+    if (vec == NULL) return 0;
+
+    return vec->length;
+}
+
+
+size_t misc_smallvec_capacity(const misc_smallvec vec)
+{
+    if (vec == NULL) return 0;
+
+    return vec->capacity;
+}
+
+
+int misc_smallvec_isempty(const misc_smallvec vec)
+{
+    return vec == NULL || vec->length == 0;
+}
+
+
+int misc_smallvec_isinline(const misc_smallvec vec)
+{
+    return vec != NULL && IS_INLINE(vec);
+}
+
+
+int misc_smallvec_pushback(misc_smallvec vec, const void *elem)
+{
+    if (vec == NULL || elem == NULL) return 0;
+    if (vec->length == vec->capacity && !_misc_smallvec_grow(vec, vec->length + 1)) return 0;
+
+    memcpy((uint8_t*)vec->data + (vec->length * vec->elem_size), elem, vec->elem_size);
+    vec->length++;
+    return 1;
+}
+
+
+void misc_smallvec_popback(misc_smallvec vec, void *out)
+{
+    if (vec == NULL || vec->length == 0) return;
+
+    vec->length--;
+    if (out != NULL)
+    {
+        memcpy(out, (uint8_t*)vec->data + (vec->length * vec->elem_size), vec->elem_size);
+    }
+}
+
+
+int misc_smallvec_insert(misc_smallvec vec, size_t idx, const void *elem)
+{
+    if (vec == NULL || elem == NULL) return 0;
+    if (idx > vec->length) return 0;
+    if (vec->length == vec->capacity && !_misc_smallvec_grow(vec, vec->length + 1)) return 0;
+
+    uint8_t *pos = (uint8_t*)vec->data + (idx * vec->elem_size);
+    if (idx < vec->length)
+    {
+        memmove(pos + vec->elem_size, pos, (vec->length - idx) * vec->elem_size);
+    }
+
+    memcpy(pos, elem, vec->elem_size);
+    vec->length++;
+
+    return 1;
+}
+
+
+int misc_smallvec_remove(misc_smallvec vec, size_t idx, void *out)
+{
+    if (vec == NULL) return 0;
+    if (idx >= vec->length) return 0;
+
+    uint8_t *pos = (uint8_t*)vec->data + (idx * vec->elem_size);
+    if (out != NULL) memcpy(out, pos, vec->elem_size);
+
+    if (idx < vec->length - 1)
+    {
+        memmove(pos, pos + vec->elem_size, (vec->length - idx - 1) * vec->elem_size);
+    }
+
+    vec->length--;
+
+    return 1;
+}
+
+
+void misc_smallvec_set(misc_smallvec vec, size_t idx, const void *elem)
+{
+    if (vec == NULL || elem == NULL) return;
+    if (idx >= vec->length) return;
+
+    memcpy((uint8_t*)vec->data + (idx * vec->elem_size), elem, vec->elem_size);
+}
+
+
+void* misc_smallvec_get(const misc_smallvec vec, size_t idx)
+{
+    if (vec == NULL) return NULL;
+    if (idx >= vec->length) return NULL;
+
+    return (uint8_t*)vec->data + (idx * vec->elem_size);
+}
+
+
+void* misc_smallvec_front(const misc_smallvec vec)
+{
+    return misc_smallvec_get(vec, 0);
+}
+
+
+void* misc_smallvec_back(const misc_smallvec vec)
+{
+    if (vec == NULL || vec->length == 0) return NULL;
+
+    return misc_smallvec_get(vec, vec->length - 1);
+}
+
+
+int misc_smallvec_shrink_to_fit(misc_smallvec vec)
+{
+    if (vec == NULL) return 0;
+    if (IS_INLINE(vec)) return 1;
+
+    if (vec->length <= vec->inline_capacity)
+    {
+        memcpy(vec->inline_data, vec->data, vec->length * vec->elem_size);
+        free(vec->data);
+        vec->data = vec->inline_data;
+        vec->capacity = vec->inline_capacity;
+        return 1;
+    }
+
+    if (vec->length == vec->capacity) return 1;
+
+    void *new_data = realloc(vec->data, vec->length * vec->elem_size);
+    if (new_data == NULL) return 0;
+
+    vec->data = new_data;
+    vec->capacity = vec->length;
+    return 1;
+}
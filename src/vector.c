@@ -12,33 +12,82 @@ struct misc_generic_vector
     size_t length;
     size_t capacity;
     size_t elem_size;
+    double growth;
 
 };
 
 
+/*
+ * Grows the buffer to hold at least min_cap elements, by the growth factor
+ * if that is larger. Going through realloc lets the allocator extend the
+ * block in place, and large blocks be moved with mremap instead of copied.
+ */
+static int _misc_vector_grow(misc_vector vec, size_t min_cap)
+{
+    if (min_cap <= vec->capacity) return 1;
+
+    size_t max_cap = SIZE_MAX / vec->elem_size;
+    if (min_cap > max_cap) return 0;
+
+    size_t new_cap = min_cap;
+    double grown = (double)vec->capacity * vec->growth;
+    if (grown > (double)max_cap) grown = (double)max_cap;
+    if ((size_t)grown > new_cap) new_cap = (size_t)grown;
+
+    void *new_data = realloc(vec->data, new_cap * vec->elem_size);
+    if (new_data == NULL) return 0;
+
+    vec->data = new_data;
+    vec->capacity = new_cap;
+    return 1;
+}
+
+
 misc_vector misc_vector_create(size_t elem_size)
+{
+    return misc_vector_create_with_capacity(elem_size, DEFAULT_CAPACITY);
+}
+
+
+misc_vector misc_vector_create_with_capacity(size_t elem_size, size_t capacity)
 {
     if (elem_size == 0) return NULL;
+    if (capacity > SIZE_MAX / elem_size) return NULL;
 
     misc_vector vec = (misc_vector) malloc(sizeof(struct misc_generic_vector));
     if (vec == NULL) return NULL;
 
-    void *data = malloc(DEFAULT_CAPACITY * elem_size);
-    if (data == NULL)
+    void *data = NULL;
+    if (capacity > 0)
     {
-        free((void*)vec);
-        return NULL;
+        data = malloc(capacity * elem_size);
+        if (data == NULL)
+        {
+            free((void*)vec);
+            return NULL;
+        }
     }
 
     vec->data = data;
     vec->length = 0;
-    vec->capacity = DEFAULT_CAPACITY;
+    vec->capacity = capacity;
     vec->elem_size = elem_size;
+    vec->growth = MISC_VECTOR_GROWTH_FACTOR;
 
     return vec;
 }
 
 
+int misc_vector_set_growth_factor(misc_vector vec, double factor)
+{
+    if (vec == NULL) return 0;
+    if (!(factor > 1.0)) return 0;
+
+    vec->growth = factor;
+    return 1;
+}
+
+
 void misc_vector_destroy(misc_vector vec)
 {
     if (vec != NULL)
@@ -73,28 +122,112 @@ int misc_vector_isempty(const misc_vector vec)
 }
 
 
-int misc_vector_pushback(misc_vector vec, const void *elem)
+int misc_vector_reserve(misc_vector vec, size_t capacity)
 {
-    if (vec == NULL || elem == NULL) return 0;
+    if (vec == NULL) return 0;
+    if (capacity <= vec->capacity) return 1;
+    if (capacity > SIZE_MAX / vec->elem_size) return 0;
 
-    if (vec->length == vec->capacity)
+    void *new_data = realloc(vec->data, capacity * vec->elem_size);
+    if (new_data == NULL) return 0;
+
+    vec->data = new_data;
+    vec->capacity = capacity;
+    return 1;
+}
+
+
+int misc_vector_resize(misc_vector vec, size_t length, const void *fill)
+{
+    if (vec == NULL) return 0;
+
+    if (length > vec->length)
     {
-        size_t new_cap = vec->capacity * 2;
-        void *new_data = malloc(new_cap * vec->elem_size);
-        if (new_data == NULL) return 0;
+        if (!_misc_vector_grow(vec, length)) return 0;
+
+        uint8_t *pos = (uint8_t*)vec->data + (vec->length * vec->elem_size);
+        if (fill == NULL)
+        {
+            memset(pos, 0, (length - vec->length) * vec->elem_size);
+        }
+        else
+        {
+            for (size_t i = vec->length; i < length; i++, pos += vec->elem_size)
+            {
+                memcpy(pos, fill, vec->elem_size);
+            }
+        }
+    }
+
+    vec->length = length;
+    return 1;
+}
 
-        memcpy(new_data, vec->data, vec->length * vec->elem_size);
+
+int misc_vector_shrink_to_fit(misc_vector vec)
+{
+    if (vec == NULL) return 0;
+    if (vec->length == vec->capacity) return 1;
+
+    if (vec->length == 0)
+    {
         free(vec->data);
-        vec->data = new_data;
-        vec->capacity = new_cap;
+        vec->data = NULL;
+        vec->capacity = 0;
+        return 1;
     }
 
+    void *new_data = realloc(vec->data, vec->length * vec->elem_size);
+    if (new_data == NULL) return 0;
+
+    vec->data = new_data;
+    vec->capacity = vec->length;
+    return 1;
+}
+
+
+int misc_vector_pushback(misc_vector vec, const void *elem)
+{
+    if (vec == NULL || elem == NULL) return 0;
+
+    if (vec->length == vec->capacity && !_misc_vector_grow(vec, vec->length + 1)) return 0;
+
     memcpy((uint8_t*)vec->data + (vec->length*vec->elem_size), elem, vec->elem_size);
     vec->length++;
     return 1;
 }
 
 
+int misc_vector_pushback_n(misc_vector vec, const void *elems, size_t n)
+{
+    if (vec == NULL || (elems == NULL && n > 0)) return 0;
+    if (n == 0) return 1;
+    if (n > SIZE_MAX - vec->length) return 0;
+    if (!_misc_vector_grow(vec, vec->length + n)) return 0;
+
+    memcpy((uint8_t*)vec->data + (vec->length * vec->elem_size), elems, n * vec->elem_size);
+    vec->length += n;
+    return 1;
+}
+
+
+int misc_vector_append_vector(misc_vector dst, const misc_vector src)
+{
+    if (dst == NULL || src == NULL) return 0;
+    if (dst->elem_size != src->elem_size) return 0;
+
+    /* src may be dst itself: its length is read before the buffer can move */
+    size_t n = src->length;
+    if (n == 0) return 1;
+    if (n > SIZE_MAX - dst->length) return 0;
+    if (!_misc_vector_grow(dst, dst->length + n)) return 0;
+
+    memcpy((uint8_t*)dst->data + (dst->length * dst->elem_size), src->data, n * dst->elem_size);
+    dst->length += n;
+    return 1;
+}
+
+
 void misc_vector_popback(misc_vector vec, void *out)
 {
     if (vec == NULL || vec->length == 0) return;
@@ -112,17 +245,7 @@ int misc_vector_insert(misc_vector vec, size_t idx, const void *elem)
     if (vec == NULL || elem == NULL) return 0;
     if (idx > vec->length) return 0;
 
-    if (vec->length == vec->capacity)
-    {
-        size_t new_cap = vec->capacity * 2;
-        void *new_data = malloc(new_cap * vec->elem_size);
-        if (new_data == NULL) return 0;
-
-        memcpy(new_data, vec->data, vec->length * vec->elem_size);
-        free(vec->data);
-        vec->data = new_data;
-        vec->capacity = new_cap;
-    }
+    if (vec->length == vec->capacity && !_misc_vector_grow(vec, vec->length + 1)) return 0;
 
     if (idx < vec->length)
     {
@@ -141,6 +264,27 @@ int misc_vector_insert(misc_vector vec, size_t idx, const void *elem)
 }
 
 
+int misc_vector_insert_n(misc_vector vec, size_t idx, const void *elems, size_t n)
+{
+    if (vec == NULL || (elems == NULL && n > 0)) return 0;
+    if (idx > vec->length) return 0;
+    if (n == 0) return 1;
+    if (n > SIZE_MAX - vec->length) return 0;
+    if (!_misc_vector_grow(vec, vec->length + n)) return 0;
+
+    uint8_t *pos = (uint8_t*)vec->data + (idx * vec->elem_size);
+    if (idx < vec->length)
+    {
+        memmove(pos + (n * vec->elem_size), pos, (vec->length - idx) * vec->elem_size);
+    }
+
+    memcpy(pos, elems, n * vec->elem_size);
+    vec->length += n;
+
+    return 1;
+}
+
+
 int misc_vector_remove(misc_vector vec, size_t idx, void *out)
 {
     if (vec == NULL) return 0;
@@ -168,6 +312,27 @@ int misc_vector_remove(misc_vector vec, size_t idx, void *out)
 }
 
 
+int misc_vector_remove_range(misc_vector vec, size_t idx, size_t n, void *out)
+{
+    if (vec == NULL) return 0;
+    if (idx > vec->length || n > vec->length - idx) return 0;
+    if (n == 0) return 1;
+
+    uint8_t *pos = (uint8_t*)vec->data + (idx * vec->elem_size);
+    if (out != NULL) memcpy(out, pos, n * vec->elem_size);
+
+    size_t tail = vec->length - idx - n;
+    if (tail > 0)
+    {
+        memmove(pos, pos + (n * vec->elem_size), tail * vec->elem_size);
+    }
+
+    vec->length -= n;
+
+    return 1;
+}
+
+
 void misc_vector_set(misc_vector vec, size_t idx, const void *elem)
 {
     if (vec == NULL || elem == NULL) return;
@@ -197,4 +362,4 @@ void* misc_vector_back(const misc_vector vec)
 {
     if (vec->length == 0) return NULL;
     return misc_vector_get(vec, vec->length-1);
-}
\ No newline at end of file
+}